@@ -0,0 +1,9 @@
+// camera and light, uploaded once per frame and shared by every scene shader
+layout(std140) uniform FrameConstants {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+    vec3 lightPos;
+    vec3 lightColor;
+    float lightIntensity;
+};
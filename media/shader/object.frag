@@ -0,0 +1,30 @@
+#version 330 core
+
+in vec3 worldPosition;
+#ifdef LIT
+in vec3 normal;
+#include "phong.glsl"
+#endif
+
+#ifdef TEXTURED
+in vec2 fTexCoord;
+uniform sampler2D mapKd;
+#else
+uniform vec3 objectColor;
+#endif
+
+out vec4 fragColor;
+
+void main() {
+#ifdef TEXTURED
+    vec4 baseColor = texture(mapKd, fTexCoord);
+#else
+    vec4 baseColor = vec4(objectColor, 1.0);
+#endif
+
+#ifdef LIT
+    fragColor = vec4(phong(normalize(normal), worldPosition) * baseColor.rgb, 1.0);
+#else
+    fragColor = baseColor;
+#endif
+}
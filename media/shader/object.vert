@@ -0,0 +1,74 @@
+#version 330 core
+#include "frame_constants.glsl"
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+#ifdef INSTANCED
+// per instance attributes, see InstancedModel
+layout(location = 3) in mat4 instanceModel;
+layout(location = 7) in mat3 instanceNormalMatrix;
+#else
+uniform mat4 model;
+uniform mat3 normalMatrix;
+#endif
+
+#ifdef MORPH
+// the target mesh's vertices, see Model::setMorphTarget()
+layout(location = 10) in vec3 aMorphPosition;
+layout(location = 11) in vec3 aMorphNormal;
+layout(location = 12) in vec2 aMorphTexCoord;
+uniform float morphWeight;
+#endif
+
+#ifdef SKINNED
+#define MAX_BONES 64
+layout(location = 13) in ivec4 aBoneIds;
+layout(location = 14) in vec4 aBoneWeights;
+uniform mat4 bones[MAX_BONES];
+#endif
+
+out vec3 worldPosition;
+#ifdef LIT
+out vec3 normal;
+#endif
+#ifdef TEXTURED
+out vec2 fTexCoord;
+#endif
+
+void main() {
+    vec3 position = aPosition;
+    vec3 vertexNormal = aNormal;
+    vec2 texCoord = aTexCoord;
+
+#ifdef MORPH
+    position = mix(position, aMorphPosition, morphWeight);
+    vertexNormal = mix(vertexNormal, aMorphNormal, morphWeight);
+    texCoord = mix(texCoord, aMorphTexCoord, morphWeight);
+#endif
+
+#ifdef SKINNED
+    mat4 skin = aBoneWeights.x * bones[aBoneIds.x] + aBoneWeights.y * bones[aBoneIds.y]
+              + aBoneWeights.z * bones[aBoneIds.z] + aBoneWeights.w * bones[aBoneIds.w];
+    position = vec3(skin * vec4(position, 1.0));
+    vertexNormal = mat3(skin) * vertexNormal;
+#endif
+
+#ifdef INSTANCED
+    mat4 modelMatrix = instanceModel;
+    mat3 normalTransform = instanceNormalMatrix;
+#else
+    mat4 modelMatrix = model;
+    mat3 normalTransform = normalMatrix;
+#endif
+
+    worldPosition = vec3(modelMatrix * vec4(position, 1.0));
+#ifdef LIT
+    normal = normalTransform * vertexNormal;
+#endif
+#ifdef TEXTURED
+    fTexCoord = texCoord;
+#endif
+    gl_Position = projection * view * vec4(worldPosition, 1.0);
+}
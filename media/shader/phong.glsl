@@ -0,0 +1,24 @@
+#include "frame_constants.glsl"
+
+uniform float ambientStrength;
+uniform float specularStrength;
+uniform float shininess;
+
+// light reaching a surface point, to be multiplied with its color
+vec3 phong(vec3 normal, vec3 worldPosition) {
+    // Ambient lighting
+    vec3 ambient = ambientStrength * lightColor;
+
+    // Diffuse lighting
+    vec3 lightDir = normalize(lightPos - worldPosition);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor;
+
+    // Specular lighting
+    vec3 viewDir = normalize(viewPos - worldPosition);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    vec3 specular = specularStrength * spec * lightColor;
+
+    return (ambient + diffuse + specular) * lightIntensity;
+}
@@ -0,0 +1,90 @@
+#include "allocation_tracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// plain thread_locals, no constructor runs inside operator new
+thread_local uint64_t tlsAllocations = 0;
+thread_local uint64_t tlsBytes = 0;
+std::atomic<uint64_t> totalAllocations{0};
+std::atomic<uint64_t> totalBytes{0};
+
+void* allocate(std::size_t size) {
+    ++tlsAllocations;
+    tlsBytes += size;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* pointer = allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* pointer = allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+AllocationCounts AllocationTracker::getThreadCounts() {
+    return {tlsAllocations, tlsBytes};
+}
+
+AllocationCounts AllocationTracker::getTotalCounts() {
+    return {totalAllocations.load(std::memory_order_relaxed),
+            totalBytes.load(std::memory_order_relaxed)};
+}
+
+#else
+
+AllocationCounts AllocationTracker::getThreadCounts() {
+    return {};
+}
+
+AllocationCounts AllocationTracker::getTotalCounts() {
+    return {};
+}
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Heap allocations counted by the global operator new replacement in allocation_tracker.cpp.
+// Only built in with -DTRACK_ALLOCATIONS=ON, otherwise every count reads zero.
+class AllocationTracker {
+public:
+    static constexpr bool isEnabled() {
+#ifdef TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // allocations made by the calling thread since it started, cheap enough for every scope
+    static AllocationCounts getThreadCounts();
+
+    // allocations made by all threads since the process started
+    static AllocationCounts getTotalCounts();
+};
@@ -1,9 +1,43 @@
+#include <algorithm>
+#include <thread>
+
 #include "application.h"
+#include "gl_call_stats.h"
+#include "tracer.h"
+
+namespace {
+// Stops and joins the simulation thread however run() is left; a joinable std::thread
+// destroyed while an exception unwinds would call std::terminate.
+class SimulationThreadGuard {
+public:
+    SimulationThreadGuard(std::thread& thread, std::atomic<bool>& running)
+        : _thread(thread), _running(running) {}
+
+    SimulationThreadGuard(const SimulationThreadGuard&) = delete;
+
+    ~SimulationThreadGuard() {
+        stop();
+    }
+
+    void stop() {
+        if (_thread.joinable()) {
+            _running = false;
+            _thread.join();
+        }
+    }
+
+private:
+    std::thread& _thread;
+    std::atomic<bool>& _running;
+};
+}  // namespace
 
 Application::Application(const Options& options)
     : _assetRootDir(options.assetRootDir), _windowTitle(options.windowTitle),
       _windowWidth(options.windowWidth), _windowHeight(options.windowHeight),
-      _clearColor(options.backgroundColor) {
+      _fixedDeltaTime(1.0f / options.simulationRate),
+      _maxSimulationSteps(options.maxSimulationSteps),
+      _threadedSimulation(options.threadedSimulation), _clearColor(options.backgroundColor) {
     // set error callback
     glfwSetErrorCallback(errorCallback);
 
@@ -48,6 +82,7 @@ Application::Application(const Options& options)
     if (!gladLoadGL(glfwGetProcAddress)) {
         throw std::runtime_error("glad initialization OpenGL failure");
     }
+    GLCallStats::install();
 
     std::cout << "OpenGL\n";
     std::cout << "+ version:    " << glGetString(GL_VERSION) << '\n';
@@ -84,14 +119,54 @@ Application::~Application() {
 }
 
 void Application::run() {
+    std::thread simulationThread;
+    SimulationThreadGuard simulationGuard(simulationThread, _simulationRunning);
+    if (_threadedSimulation) {
+        _simulationError = nullptr;
+        _simulationRunning = true;
+        simulationThread = std::thread(&Application::runSimulationThread, this);
+    }
+
+    Tracer::setThreadName("render");
     while (!glfwWindowShouldClose(_window)) {
+        // the simulation thread only stops by itself when updateSimulation() threw
+        if (_threadedSimulation && !_simulationRunning.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        TRACE_SCOPE("frame");
         updateTime();
-        handleInput();
-        renderFrame();
+        const auto frameStart = _lastTimeStamp;
+
+        {
+            TRACE_SCOPE("handleInput");
+            handleInput();
+        }
+        {
+            TRACE_SCOPE("main thread jobs");
+            _jobSystem.executeMainThreadJobs();
+        }
+        if (!_threadedSimulation) {
+            TRACE_SCOPE("stepSimulation");
+            stepSimulation();
+        }
+        {
+            TRACE_SCOPE("renderFrame");
+            renderFrame();
+        }
 
+        // time blocked in swap (vsync) does not count as render work
+        _renderUtilization.addBusyTime(std::chrono::high_resolution_clock::now() - frameStart);
+
+        TRACE_SCOPE("swapBuffers");
         glfwSwapBuffers(_window);
         glfwPollEvents();
     }
+
+    simulationGuard.stop();
+    if (_simulationError) {
+        std::rethrow_exception(_simulationError);
+    }
 }
 
 std::string Application::getAssetFullPath(const std::string& resourceRelPath) const {
@@ -107,9 +182,64 @@ void Application::updateTime() {
     }
 }
 
+void Application::stepSimulation() {
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // clamp the frame time so that a long hitch cannot queue up more ticks than we
+    // can afford to run (spiral of death); the lost time is simply dropped
+    _simulationAccumulator += std::min(_deltaTime, _maxSimulationSteps * _fixedDeltaTime);
+    while (_simulationAccumulator >= _fixedDeltaTime) {
+        updateSimulation();
+        _simulationAccumulator -= _fixedDeltaTime;
+    }
+
+    // how far the render time is between the last two ticks
+    _interpolationAlpha = _simulationAccumulator / _fixedDeltaTime;
+
+    _simulationUtilization.addBusyTime(std::chrono::high_resolution_clock::now() - start);
+}
+
+void Application::runSimulationThread() {
+    using Clock = std::chrono::high_resolution_clock;
+    const auto tickDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(_fixedDeltaTime));
+
+    Tracer::setThreadName("simulation");
+    auto nextTick = Clock::now();
+    try {
+        while (_simulationRunning.load(std::memory_order_acquire)) {
+            const auto now = Clock::now();
+            if (now < nextTick) {
+                std::this_thread::sleep_until(nextTick);
+                continue;
+            }
+
+            // same spiral-of-death clamp as stepSimulation(): drop a backlog we cannot catch up on
+            if (now - nextTick > _maxSimulationSteps * tickDuration) {
+                nextTick = now;
+            }
+
+            {
+                TRACE_SCOPE("tick");
+                updateSimulation();
+            }
+            nextTick += tickDuration;
+
+            _simulationUtilization.addBusyTime(Clock::now() - now);
+        }
+    } catch (...) {
+        // handed to the render thread, which leaves run() and rethrows it after the join
+        _simulationError = std::current_exception();
+        _simulationRunning.store(false, std::memory_order_release);
+    }
+}
+
 void Application::showFpsInWindowTitle() {
     float fps = _fpsIndicator.getAverageFrameRate();
-    std::string detailTitle = _windowTitle + ": " + std::to_string(fps) + " fps";
+    int sim = static_cast<int>(100.0f * _simulationUtilization.getUtilization());
+    int render = static_cast<int>(100.0f * _renderUtilization.getUtilization());
+    std::string detailTitle = _windowTitle + ": " + std::to_string(fps) + " fps | sim "
+                              + std::to_string(sim) + "% | render " + std::to_string(render) + "%";
     glfwSetWindowTitle(_window, detailTitle.c_str());
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <exception>
 #include <functional>
 #include <stdexcept>
 #include <string>
@@ -12,6 +14,8 @@
 #include "frame_rate_indicator.h"
 #include "gl_utility.h"
 #include "input.h"
+#include "job_system.h"
+#include "utilization_meter.h"
 
 struct Options {
     std::string assetRootDir;
@@ -23,6 +27,9 @@ struct Options {
     bool msaa;
     std::pair<int, int> glVersion;
     glm::vec4 backgroundColor;
+    float simulationRate;
+    int maxSimulationSteps;
+    bool threadedSimulation;
 };
 
 class Application {
@@ -53,6 +60,23 @@ protected:
     float _deltaTime = 0.0f;
     FrameRateIndicator _fpsIndicator{64};
 
+    /* fixed-step simulation */
+    float _fixedDeltaTime = 1.0f / 60.0f;
+    int _maxSimulationSteps = 5;
+    float _simulationAccumulator = 0.0f;
+    float _interpolationAlpha = 0.0f;
+
+    /* simulation thread, updateSimulation() must not touch GL when it is enabled */
+    bool _threadedSimulation = false;
+    std::atomic<bool> _simulationRunning{false};
+    /* what stopped the simulation thread, rethrown by run() after the join */
+    std::exception_ptr _simulationError;
+    UtilizationMeter _simulationUtilization;
+    UtilizationMeter _renderUtilization;
+
+    /* worker threads, gl work from jobs is run on the main thread once per frame */
+    JobSystem _jobSystem;
+
     /* input handler */
     Input _input;
 
@@ -63,9 +87,16 @@ protected:
 
     void updateTime();
 
+    void stepSimulation();
+
+    void runSimulationThread();
+
     /* derived class can override this function to handle input */
     virtual void handleInput() = 0;
 
+    /* derived class can override this function to advance the game by _fixedDeltaTime */
+    virtual void updateSimulation() = 0;
+
     /* derived class can override this function to render a frame */
     virtual void renderFrame() = 0;
 
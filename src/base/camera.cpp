@@ -1,25 +1,110 @@
+#include <algorithm>
+
 #include "camera.h"
 
-glm::mat4 Camera::getViewMatrix() const {
-    return glm::lookAt(
-        transform.position, transform.position + transform.getFront(), transform.getUp());
+const glm::mat4& Camera::getViewMatrix() const {
+    update();
+    return _view;
+}
+
+const glm::mat4& Camera::getProjectionMatrix() const {
+    update();
+    return _projection;
+}
+
+const glm::mat4& Camera::getViewProjectionMatrix() const {
+    update();
+    if (!(_validFlags & ViewProjectionValid)) {
+        _viewProjection = _projection * _view;
+        _validFlags |= ViewProjectionValid;
+    }
+    return _viewProjection;
+}
+
+const glm::mat4& Camera::getInverseViewProjectionMatrix() const {
+    const glm::mat4& viewProjection = getViewProjectionMatrix();
+    if (!(_validFlags & InverseViewProjectionValid)) {
+        _inverseViewProjection = glm::inverse(viewProjection);
+        _validFlags |= InverseViewProjectionValid;
+    }
+    return _inverseViewProjection;
+}
+
+const Frustum& Camera::getFrustum() const {
+    update();
+    if (!(_validFlags & FrustumValid)) {
+        _frustum = computeFrustum();
+        _validFlags |= FrustumValid;
+    }
+    return _frustum;
+}
+
+uint32_t Camera::getVersion() const {
+    update();
+    return _version;
+}
+
+void Camera::update() const {
+    // both run every time, each refreshes what it compares against
+    const uint32_t transformVersion = transform.getVersion();
+    const bool viewChanged = transformVersion != _transformVersion;
+    const bool projectionChanged = updateProjectionParameters() || _version == 0;
+    if (!viewChanged && !projectionChanged) {
+        return;
+    }
+
+    if (viewChanged) {
+        _view = glm::lookAt(
+            transform.position, transform.position + transform.getFront(), transform.getUp());
+        _transformVersion = transformVersion;
+    }
+    if (projectionChanged) {
+        _projection = computeProjectionMatrix();
+    }
+
+    // the combined matrices and the frustum are rebuilt on their next use
+    _validFlags = 0;
+    ++_version;
 }
 
 PerspectiveCamera::PerspectiveCamera(float fovy, float aspect, float znear, float zfar)
     : fovy(fovy), aspect(aspect), znear(znear), zfar(zfar) {}
 
-glm::mat4 PerspectiveCamera::getProjectionMatrix() const {
+bool PerspectiveCamera::updateProjectionParameters() const {
+    const glm::vec4 parameters(fovy, aspect, znear, zfar);
+    if (parameters == _cachedParameters) {
+        return false;
+    }
+    _cachedParameters = parameters;
+    return true;
+}
+
+glm::mat4 PerspectiveCamera::computeProjectionMatrix() const {
     return glm::perspective(fovy, aspect, znear, zfar);
 }
 
-Frustum PerspectiveCamera::getFrustum() const {
+Frustum PerspectiveCamera::computeFrustum() const {
     Frustum frustum;
-    // TODO: construct the frustum with the position and orientation of the camera
-    // Note: this is for Bonus project 'Frustum Culling'
-    // write your code here
-    // ----------------------------------------------------------------------
-    // ...
-    // ----------------------------------------------------------------------
+    const glm::vec3 fv = transform.getFront();
+    const glm::vec3 rv = transform.getRight();
+    const glm::vec3 uv = transform.getUp();
+
+    // the side planes pass through the camera position, their normals are built from the
+    // edges of the far plane so that they point inside like the orthographic ones
+    const float halfHeight = zfar * std::tan(fovy * 0.5f);
+    const float halfWidth = halfHeight * aspect;
+    const glm::vec3 farCenter = zfar * fv;
+
+    frustum.planes[Frustum::NearFace] = {transform.position + znear * fv, fv};
+    frustum.planes[Frustum::FarFace] = {transform.position + farCenter, -fv};
+    frustum.planes[Frustum::LeftFace] = {
+        transform.position, glm::cross(farCenter - halfWidth * rv, uv)};
+    frustum.planes[Frustum::RightFace] = {
+        transform.position, glm::cross(uv, farCenter + halfWidth * rv)};
+    frustum.planes[Frustum::BottomFace] = {
+        transform.position, glm::cross(rv, farCenter - halfHeight * uv)};
+    frustum.planes[Frustum::TopFace] = {
+        transform.position, glm::cross(farCenter + halfHeight * uv, rv)};
 
     return frustum;
 }
@@ -28,11 +113,20 @@ OrthographicCamera::OrthographicCamera(
     float left, float right, float bottom, float top, float znear, float zfar)
     : left(left), right(right), top(top), bottom(bottom), znear(znear), zfar(zfar) {}
 
-glm::mat4 OrthographicCamera::getProjectionMatrix() const {
+bool OrthographicCamera::updateProjectionParameters() const {
+    const float parameters[6] = {left, right, bottom, top, znear, zfar};
+    if (std::equal(parameters, parameters + 6, _cachedParameters)) {
+        return false;
+    }
+    std::copy(parameters, parameters + 6, _cachedParameters);
+    return true;
+}
+
+glm::mat4 OrthographicCamera::computeProjectionMatrix() const {
     return glm::ortho(left, right, bottom, top, znear, zfar);
 }
 
-Frustum OrthographicCamera::getFrustum() const {
+Frustum OrthographicCamera::computeFrustum() const {
     Frustum frustum;
     const glm::vec3 fv = transform.getFront();
     const glm::vec3 rv = transform.getRight();
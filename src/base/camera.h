@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
+
 #include "frustum.h"
 #include "transform.h"
 
+// The matrices and the frustum are cached and only recomputed after the transform or the
+// projection parameters changed, each of them at most once per change.
 class Camera {
 public:
     Transform transform;
@@ -10,11 +14,45 @@ public:
 public:
     virtual ~Camera() = default;
 
-    glm::mat4 getViewMatrix() const;
+    const glm::mat4& getViewMatrix() const;
+
+    const glm::mat4& getProjectionMatrix() const;
+
+    const glm::mat4& getViewProjectionMatrix() const;
+
+    const glm::mat4& getInverseViewProjectionMatrix() const;
+
+    const Frustum& getFrustum() const;
+
+    // changes whenever any of the above does, see Transform::getVersion()
+    uint32_t getVersion() const;
+
+protected:
+    // true if the projection parameters differ from the last call, which remembers them
+    virtual bool updateProjectionParameters() const = 0;
+
+    virtual glm::mat4 computeProjectionMatrix() const = 0;
 
-    virtual glm::mat4 getProjectionMatrix() const = 0;
+    virtual Frustum computeFrustum() const = 0;
 
-    virtual Frustum getFrustum() const = 0;
+private:
+    enum CacheFlags : uint32_t {
+        ViewProjectionValid = 1 << 0,
+        InverseViewProjectionValid = 1 << 1,
+        FrustumValid = 1 << 2
+    };
+
+    mutable glm::mat4 _view = glm::mat4(1.0f);
+    mutable glm::mat4 _projection = glm::mat4(1.0f);
+    mutable glm::mat4 _viewProjection = glm::mat4(1.0f);
+    mutable glm::mat4 _inverseViewProjection = glm::mat4(1.0f);
+    mutable Frustum _frustum;
+    // the transform version _view was built from, 0 before the first update
+    mutable uint32_t _transformVersion = 0;
+    mutable uint32_t _version = 0;
+    mutable uint32_t _validFlags = 0;
+
+    void update() const;
 };
 
 class PerspectiveCamera : public Camera {
@@ -29,9 +67,16 @@ public:
 
     ~PerspectiveCamera() = default;
 
-    glm::mat4 getProjectionMatrix() const override;
+protected:
+    bool updateProjectionParameters() const override;
+
+    glm::mat4 computeProjectionMatrix() const override;
+
+    Frustum computeFrustum() const override;
 
-    virtual Frustum getFrustum() const override;
+private:
+    // fovy, aspect, znear and zfar the cached projection was built from
+    mutable glm::vec4 _cachedParameters{0.0f};
 };
 
 class OrthographicCamera : public Camera {
@@ -48,7 +93,14 @@ public:
 
     ~OrthographicCamera() = default;
 
-    glm::mat4 getProjectionMatrix() const override;
+protected:
+    bool updateProjectionParameters() const override;
 
-    virtual Frustum getFrustum() const override;
-};
\ No newline at end of file
+    glm::mat4 computeProjectionMatrix() const override;
+
+    Frustum computeFrustum() const override;
+
+private:
+    // left, right, bottom, top, znear and zfar the cached projection was built from
+    mutable float _cachedParameters[6] = {};
+};
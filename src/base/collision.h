@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+// Continuous collision between two spheres that both move linearly over one tick.
+// a0/a1 and b0/b1 are the sphere centers at the start and the end of the tick.
+// The test is done in the frame of sphere b, which turns it into a segment-vs-sphere
+// test of the relative motion against a sphere of radius (ra + rb) at the origin.
+// On hit, timeOfImpact is the first contact time in [0, 1] (0 if already overlapping).
+inline bool sweptSphereIntersection(
+    const glm::vec3& a0, const glm::vec3& a1, float ra, const glm::vec3& b0, const glm::vec3& b1,
+    float rb, float& timeOfImpact) {
+    const glm::vec3 start = a0 - b0;
+    const glm::vec3 motion = (a1 - b1) - start;
+    const float radius = ra + rb;
+
+    // |start + t * motion|^2 = radius^2
+    const float c = glm::dot(start, start) - radius * radius;
+    if (c < 0.0f) {
+        timeOfImpact = 0.0f;
+        return true;
+    }
+
+    const float a = glm::dot(motion, motion);
+    if (a <= 0.0f) {
+        return false;
+    }
+
+    const float b = glm::dot(start, motion);
+    if (b >= 0.0f) {
+        // moving apart
+        return false;
+    }
+
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) {
+        return false;
+    }
+
+    const float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.0f) {
+        return false;
+    }
+
+    timeOfImpact = std::max(t, 0.0f);
+    return true;
+}
+
+inline bool segmentIntersectsSphere(
+    const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& center, float radius,
+    float& timeOfImpact) {
+    return sweptSphereIntersection(p0, p1, 0.0f, center, center, radius, timeOfImpact);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Min-heap of timed events, each identified by an integer id (e.g. an index into an array
+// of game objects). Popping the due events costs O(k log n) for k due events, no matter
+// how many events are waiting, so idle objects cost nothing per tick.
+class EventScheduler {
+public:
+    void schedule(uint32_t id, float time) {
+        _events.push_back({time, id});
+        std::push_heap(_events.begin(), _events.end(), Later());
+    }
+
+    // calls callback(id, time) for every event due at or before now, earliest first;
+    // the callback may schedule new events, they are not considered until the next call
+    template <typename Callback>
+    void runDue(float now, Callback callback) {
+        _due.clear();
+        while (!_events.empty() && _events.front().time <= now) {
+            std::pop_heap(_events.begin(), _events.end(), Later());
+            _due.push_back(_events.back());
+            _events.pop_back();
+        }
+
+        for (const auto& event : _due) {
+            callback(event.id, event.time);
+        }
+    }
+
+    void clear() {
+        _events.clear();
+    }
+
+    size_t size() const {
+        return _events.size();
+    }
+
+private:
+    struct Event {
+        float time;
+        uint32_t id;
+    };
+
+    struct Later {
+        bool operator()(const Event& lhs, const Event& rhs) const {
+            return lhs.time > rhs.time;
+        }
+    };
+
+    std::vector<Event> _events;
+    std::vector<Event> _due;
+};
@@ -1,8 +1,10 @@
 #include "framebuffer.h"
+#include "gl_resource_registry.h"
 #include <stdexcept>
 
 Framebuffer::Framebuffer() {
     glGenFramebuffers(1, &_handle);
+    GLResourceRegistry::onCreate(GLResourceType::Framebuffer, _handle);
 }
 
 Framebuffer::Framebuffer(Framebuffer&& rhs) noexcept {
@@ -12,6 +14,7 @@ Framebuffer::Framebuffer(Framebuffer&& rhs) noexcept {
 
 Framebuffer::~Framebuffer() {
     if (_handle != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Framebuffer, _handle);
         glDeleteFramebuffers(1, &_handle);
         _handle = 0;
     }
@@ -16,13 +16,35 @@ public:
         FarFace = 5
     };
 
+    // conservative: the box is moved to world space as the aabb around the transformed box,
+    // and only rejected when it lies entirely behind one of the planes
     bool intersect(const BoundingBox& aabb, const glm::mat4& modelMatrix) const {
-        // TODO: judge whether the frustum intersects the bounding box
-        // Note: this is for Bonus project 'Frustum Culling'
-        // write your code here
-        // ------------------------------------------------------------
+        const glm::vec3 localCenter = 0.5f * (aabb.max + aabb.min);
+        const glm::vec3 localExtent = 0.5f * (aabb.max - aabb.min);
+        const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(localCenter, 1.0f));
+        const glm::mat3 absolute(
+            glm::abs(glm::vec3(modelMatrix[0])), glm::abs(glm::vec3(modelMatrix[1])),
+            glm::abs(glm::vec3(modelMatrix[2])));
+        const glm::vec3 extent = absolute * localExtent;
+
+        for (const auto& plane : planes) {
+            const float radius = glm::dot(extent, glm::abs(plane.normal));
+            if (plane.getSignedDistanceToPoint(center) < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool intersect(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (plane.getSignedDistanceToPoint(center) < -radius) {
+                return false;
+            }
+        }
+
         return true;
-        // ------------------------------------------------------------
     }
 };
 
@@ -0,0 +1,139 @@
+#include <cmath>
+
+#include "frustum_culling.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLING_SSE
+#endif
+
+void BoundingSpheres::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+}
+
+void BoundingSpheres::add(const glm::vec3& center, float sphereRadius) {
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(sphereRadius);
+}
+
+void BoundingBoxes::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+void BoundingBoxes::add(const BoundingBox& aabb, const glm::mat4& modelMatrix) {
+    const glm::vec3 localCenter = 0.5f * (aabb.max + aabb.min);
+    const glm::vec3 localExtent = 0.5f * (aabb.max - aabb.min);
+    const glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(localCenter, 1.0f));
+    const glm::mat3 absolute(
+        glm::abs(glm::vec3(modelMatrix[0])), glm::abs(glm::vec3(modelMatrix[1])),
+        glm::abs(glm::vec3(modelMatrix[2])));
+    const glm::vec3 extent = absolute * localExtent;
+
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extent.x);
+    extentY.push_back(extent.y);
+    extentZ.push_back(extent.z);
+}
+
+namespace {
+// the scalar test, also used for the objects left over after the last group of four
+bool isVisible(const Frustum& frustum, float x, float y, float z, float ex, float ey, float ez,
+               float radius) {
+    for (const auto& plane : frustum.planes) {
+        const float reach = radius + ex * std::abs(plane.normal.x) +
+                            ey * std::abs(plane.normal.y) + ez * std::abs(plane.normal.z);
+        if (plane.getSignedDistanceToPoint(glm::vec3(x, y, z)) < -reach) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// spheres are boxes with a zero extent and boxes spheres with a zero radius, which keeps
+// one loop for both; extent pointers are null for spheres and radius is null for boxes
+size_t cull(const Frustum& frustum, size_t count, const float* x, const float* y,
+            const float* z, const float* ex, const float* ey, const float* ez,
+            const float* radius, std::vector<uint8_t>& visible) {
+    visible.resize(count);
+    size_t culled = 0;
+    size_t i = 0;
+
+#ifdef FRUSTUM_CULLING_SSE
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 nx[6], ny[6], nz[6], d[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p) {
+        const Plane& plane = frustum.planes[p];
+        nx[p] = _mm_set1_ps(plane.normal.x);
+        ny[p] = _mm_set1_ps(plane.normal.y);
+        nz[p] = _mm_set1_ps(plane.normal.z);
+        d[p] = _mm_set1_ps(plane.signedDistance);
+        ax[p] = _mm_andnot_ps(signMask, nx[p]);
+        ay[p] = _mm_andnot_ps(signMask, ny[p]);
+        az[p] = _mm_andnot_ps(signMask, nz[p]);
+    }
+
+    for (; i + 4 <= count; i += 4) {
+        const __m128 cx = _mm_loadu_ps(x + i);
+        const __m128 cy = _mm_loadu_ps(y + i);
+        const __m128 cz = _mm_loadu_ps(z + i);
+        const __m128 r = radius ? _mm_loadu_ps(radius + i) : _mm_setzero_ps();
+        const __m128 sx = ex ? _mm_loadu_ps(ex + i) : _mm_setzero_ps();
+        const __m128 sy = ey ? _mm_loadu_ps(ey + i) : _mm_setzero_ps();
+        const __m128 sz = ez ? _mm_loadu_ps(ez + i) : _mm_setzero_ps();
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                _mm_add_ps(_mm_mul_ps(nz[p], cz), d[p]));
+            const __m128 reach = _mm_add_ps(
+                _mm_add_ps(r, _mm_mul_ps(ax[p], sx)),
+                _mm_add_ps(_mm_mul_ps(ay[p], sy), _mm_mul_ps(az[p], sz)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), reach)));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint8_t laneVisible = (mask >> lane) & 1;
+            visible[i + lane] = laneVisible;
+            culled += 1 - laneVisible;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const bool laneVisible = isVisible(
+            frustum, x[i], y[i], z[i], ex ? ex[i] : 0.0f, ey ? ey[i] : 0.0f,
+            ez ? ez[i] : 0.0f, radius ? radius[i] : 0.0f);
+        visible[i] = laneVisible ? 1 : 0;
+        culled += laneVisible ? 0 : 1;
+    }
+
+    return culled;
+}
+}  // namespace
+
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<uint8_t>& visible) {
+    return cull(
+        frustum, spheres.size(), spheres.centerX.data(), spheres.centerY.data(),
+        spheres.centerZ.data(), nullptr, nullptr, nullptr, spheres.radius.data(), visible);
+}
+
+size_t cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<uint8_t>& visible) {
+    return cull(
+        frustum, boxes.size(), boxes.centerX.data(), boxes.centerY.data(), boxes.centerZ.data(),
+        boxes.extentX.data(), boxes.extentY.data(), boxes.extentZ.data(), nullptr, visible);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bounding_box.h"
+#include "frustum.h"
+
+// World space bounding volumes in structure of arrays layout, so that the batch tests below
+// load one coordinate of four objects at once.
+struct BoundingSpheres {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    void clear();
+
+    void add(const glm::vec3& center, float sphereRadius);
+
+    size_t size() const {
+        return radius.size();
+    }
+};
+
+// aabbs as center and half extent
+struct BoundingBoxes {
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    void clear();
+
+    // the world space aabb around the transformed box, as in Frustum::intersect()
+    void add(const BoundingBox& aabb, const glm::mat4& modelMatrix);
+
+    size_t size() const {
+        return extentX.size();
+    }
+};
+
+// visible[i] is set to 1 when object i is at least partly inside the frustum and to 0 when it
+// lies entirely behind one of the planes; returns the number of culled objects. Four objects
+// are tested at a time with SSE when the target has it.
+size_t cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<uint8_t>& visible);
+
+size_t cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<uint8_t>& visible);
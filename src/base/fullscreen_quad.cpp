@@ -1,4 +1,5 @@
 #include "fullscreen_quad.h"
+#include "gl_resource_registry.h"
 
 FullscreenQuad::FullscreenQuad() {
     float _vertices[] = {-1.0f, 1.0f,  0.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f,
@@ -12,6 +13,9 @@ FullscreenQuad::FullscreenQuad() {
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(_vertices), &_vertices, GL_STATIC_DRAW);
+    GLResourceRegistry::onCreate(GLResourceType::VertexArray, _vao);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _vbo);
+    GLResourceRegistry::setBufferSize(_vbo, sizeof(_vertices));
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
@@ -30,11 +34,13 @@ FullscreenQuad::FullscreenQuad(FullscreenQuad&& rhs) noexcept : _vao(rhs._vao),
 
 FullscreenQuad::~FullscreenQuad() {
     if (_vao) {
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, _vao);
         glDeleteVertexArrays(1, &_vao);
         _vao = 0;
     }
 
     if (_vbo) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _vbo);
         glDeleteBuffers(1, &_vbo);
         _vbo = 0;
     }
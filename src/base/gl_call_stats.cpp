@@ -0,0 +1,319 @@
+#include "gl_call_stats.h"
+
+#ifdef GL_CALL_STATS
+
+#include <cstring>
+#include <unordered_map>
+
+#include "gl_utility.h"
+
+namespace {
+GLCallCounts counts;
+
+// the state the counted calls have set, to spot redundant ones
+constexpr int kTrackedTextureUnits = 32;
+constexpr int kTrackedTextureTargets = 3;
+GLuint currentProgram = 0;
+GLuint currentVertexArray = 0;
+GLuint activeTextureUnit = 0;
+GLuint boundTextures[kTrackedTextureUnits][kTrackedTextureTargets] = {};
+
+// last value sent per program and location; mat4 is the largest uniform the code sends
+struct UniformValue {
+    size_t size = 0;
+    unsigned char data[64];
+};
+std::unordered_map<uint64_t, UniformValue> uniformValues;
+
+PFNGLDRAWARRAYSPROC realDrawArrays = nullptr;
+PFNGLDRAWELEMENTSPROC realDrawElements = nullptr;
+PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced = nullptr;
+PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
+PFNGLUSEPROGRAMPROC realUseProgram = nullptr;
+PFNGLLINKPROGRAMPROC realLinkProgram = nullptr;
+PFNGLDELETEPROGRAMPROC realDeleteProgram = nullptr;
+PFNGLACTIVETEXTUREPROC realActiveTexture = nullptr;
+PFNGLBINDTEXTUREPROC realBindTexture = nullptr;
+PFNGLDELETETEXTURESPROC realDeleteTextures = nullptr;
+PFNGLBINDVERTEXARRAYPROC realBindVertexArray = nullptr;
+PFNGLDELETEVERTEXARRAYSPROC realDeleteVertexArrays = nullptr;
+PFNGLBUFFERDATAPROC realBufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC realBufferSubData = nullptr;
+PFNGLMAPBUFFERRANGEPROC realMapBufferRange = nullptr;
+PFNGLUNIFORM1IPROC realUniform1i = nullptr;
+PFNGLUNIFORM1UIPROC realUniform1ui = nullptr;
+PFNGLUNIFORM1FPROC realUniform1f = nullptr;
+PFNGLUNIFORM2FVPROC realUniform2fv = nullptr;
+PFNGLUNIFORM3FVPROC realUniform3fv = nullptr;
+PFNGLUNIFORM4FVPROC realUniform4fv = nullptr;
+PFNGLUNIFORMMATRIX2FVPROC realUniformMatrix2fv = nullptr;
+PFNGLUNIFORMMATRIX3FVPROC realUniformMatrix3fv = nullptr;
+PFNGLUNIFORMMATRIX4FVPROC realUniformMatrix4fv = nullptr;
+
+void count(GLCallCategory category, bool redundant = false) {
+    counts.calls[static_cast<int>(category)]++;
+    if (redundant) {
+        counts.redundant[static_cast<int>(category)]++;
+    }
+}
+
+int getTextureTargetIndex(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    case GL_TEXTURE_CUBE_MAP: return 2;
+    default: return -1;
+    }
+}
+
+void forgetUniforms(GLuint program) {
+    for (auto iter = uniformValues.begin(); iter != uniformValues.end();) {
+        if (static_cast<GLuint>(iter->first >> 32) == program) {
+            iter = uniformValues.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void countUniform(GLint location, const void* data, size_t size) {
+    if (location < 0 || size > sizeof(UniformValue::data)) {
+        count(GLCallCategory::UniformUpdate);
+        return;
+    }
+
+    const uint64_t key = (static_cast<uint64_t>(currentProgram) << 32) | static_cast<uint32_t>(location);
+    UniformValue& value = uniformValues[key];
+    const bool redundant = value.size == size && std::memcmp(value.data, data, size) == 0;
+    if (!redundant) {
+        value.size = size;
+        std::memcpy(value.data, data, size);
+    }
+    count(GLCallCategory::UniformUpdate, redundant);
+}
+
+void GLAD_API_PTR countDrawArrays(GLenum mode, GLint first, GLsizei vertexCount) {
+    count(GLCallCategory::Draw);
+    realDrawArrays(mode, first, vertexCount);
+}
+
+void GLAD_API_PTR countDrawElements(GLenum mode, GLsizei indexCount, GLenum type, const void* indices) {
+    count(GLCallCategory::Draw);
+    realDrawElements(mode, indexCount, type, indices);
+}
+
+void GLAD_API_PTR countDrawArraysInstanced(
+    GLenum mode, GLint first, GLsizei vertexCount, GLsizei instanceCount) {
+    count(GLCallCategory::Draw);
+    realDrawArraysInstanced(mode, first, vertexCount, instanceCount);
+}
+
+void GLAD_API_PTR countDrawElementsInstanced(
+    GLenum mode, GLsizei indexCount, GLenum type, const void* indices, GLsizei instanceCount) {
+    count(GLCallCategory::Draw);
+    realDrawElementsInstanced(mode, indexCount, type, indices, instanceCount);
+}
+
+void GLAD_API_PTR countUseProgram(GLuint program) {
+    count(GLCallCategory::ProgramBind, program == currentProgram);
+    currentProgram = program;
+    realUseProgram(program);
+}
+
+void GLAD_API_PTR countLinkProgram(GLuint program) {
+    // linking resets every uniform to its default
+    forgetUniforms(program);
+    realLinkProgram(program);
+}
+
+void GLAD_API_PTR countDeleteProgram(GLuint program) {
+    forgetUniforms(program);
+    realDeleteProgram(program);
+}
+
+void GLAD_API_PTR countActiveTexture(GLenum texture) {
+    activeTextureUnit = texture - GL_TEXTURE0;
+    realActiveTexture(texture);
+}
+
+void GLAD_API_PTR countBindTexture(GLenum target, GLuint texture) {
+    const int targetIndex = getTextureTargetIndex(target);
+    if (targetIndex < 0 || activeTextureUnit >= kTrackedTextureUnits) {
+        count(GLCallCategory::TextureBind);
+    } else {
+        GLuint& bound = boundTextures[activeTextureUnit][targetIndex];
+        count(GLCallCategory::TextureBind, bound == texture);
+        bound = texture;
+    }
+    realBindTexture(target, texture);
+}
+
+void GLAD_API_PTR countDeleteTextures(GLsizei n, const GLuint* textures) {
+    // deleted textures are unbound, a new one may get the same name
+    for (GLsizei i = 0; i < n; ++i) {
+        for (auto& unit : boundTextures) {
+            for (GLuint& bound : unit) {
+                if (bound == textures[i]) {
+                    bound = 0;
+                }
+            }
+        }
+    }
+    realDeleteTextures(n, textures);
+}
+
+void GLAD_API_PTR countBindVertexArray(GLuint array) {
+    count(GLCallCategory::VertexArrayBind, array == currentVertexArray);
+    currentVertexArray = array;
+    realBindVertexArray(array);
+}
+
+void GLAD_API_PTR countDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    for (GLsizei i = 0; i < n; ++i) {
+        if (arrays[i] == currentVertexArray) {
+            currentVertexArray = 0;
+        }
+    }
+    realDeleteVertexArrays(n, arrays);
+}
+
+void GLAD_API_PTR countBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    count(GLCallCategory::BufferUpload);
+    counts.uploadBytes += static_cast<uint64_t>(size);
+    realBufferData(target, size, data, usage);
+}
+
+void GLAD_API_PTR countBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    count(GLCallCategory::BufferUpload);
+    counts.uploadBytes += static_cast<uint64_t>(size);
+    realBufferSubData(target, offset, size, data);
+}
+
+// a range mapped for writing is filled by the caller, e.g. StreamBuffer, and counts as an
+// upload of the whole range
+void* GLAD_API_PTR countMapBufferRange(
+    GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    if (access & GL_MAP_WRITE_BIT) {
+        count(GLCallCategory::BufferUpload);
+        counts.uploadBytes += static_cast<uint64_t>(length);
+    }
+    return realMapBufferRange(target, offset, length, access);
+}
+
+void GLAD_API_PTR countUniform1i(GLint location, GLint v0) {
+    countUniform(location, &v0, sizeof(v0));
+    realUniform1i(location, v0);
+}
+
+void GLAD_API_PTR countUniform1ui(GLint location, GLuint v0) {
+    countUniform(location, &v0, sizeof(v0));
+    realUniform1ui(location, v0);
+}
+
+void GLAD_API_PTR countUniform1f(GLint location, GLfloat v0) {
+    countUniform(location, &v0, sizeof(v0));
+    realUniform1f(location, v0);
+}
+
+void GLAD_API_PTR countUniform2fv(GLint location, GLsizei n, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 2 * n);
+    realUniform2fv(location, n, value);
+}
+
+void GLAD_API_PTR countUniform3fv(GLint location, GLsizei n, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 3 * n);
+    realUniform3fv(location, n, value);
+}
+
+void GLAD_API_PTR countUniform4fv(GLint location, GLsizei n, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 4 * n);
+    realUniform4fv(location, n, value);
+}
+
+// the transpose flag is not part of the cached value, the code never sets it
+void GLAD_API_PTR countUniformMatrix2fv(
+    GLint location, GLsizei n, GLboolean transpose, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 4 * n);
+    realUniformMatrix2fv(location, n, transpose, value);
+}
+
+void GLAD_API_PTR countUniformMatrix3fv(
+    GLint location, GLsizei n, GLboolean transpose, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 9 * n);
+    realUniformMatrix3fv(location, n, transpose, value);
+}
+
+void GLAD_API_PTR countUniformMatrix4fv(
+    GLint location, GLsizei n, GLboolean transpose, const GLfloat* value) {
+    countUniform(location, value, sizeof(GLfloat) * 16 * n);
+    realUniformMatrix4fv(location, n, transpose, value);
+}
+} // namespace
+
+#define GL_CALL_STATS_HOOK(name)     \
+    real##name = glad_gl##name;      \
+    if (real##name != nullptr) {     \
+        glad_gl##name = count##name; \
+    }
+
+void GLCallStats::install() {
+    if (realUseProgram != nullptr) {
+        return;
+    }
+
+    GL_CALL_STATS_HOOK(DrawArrays);
+    GL_CALL_STATS_HOOK(DrawElements);
+    GL_CALL_STATS_HOOK(DrawArraysInstanced);
+    GL_CALL_STATS_HOOK(DrawElementsInstanced);
+    GL_CALL_STATS_HOOK(UseProgram);
+    GL_CALL_STATS_HOOK(LinkProgram);
+    GL_CALL_STATS_HOOK(DeleteProgram);
+    GL_CALL_STATS_HOOK(ActiveTexture);
+    GL_CALL_STATS_HOOK(BindTexture);
+    GL_CALL_STATS_HOOK(DeleteTextures);
+    GL_CALL_STATS_HOOK(BindVertexArray);
+    GL_CALL_STATS_HOOK(DeleteVertexArrays);
+    GL_CALL_STATS_HOOK(BufferData);
+    GL_CALL_STATS_HOOK(BufferSubData);
+    GL_CALL_STATS_HOOK(MapBufferRange);
+    GL_CALL_STATS_HOOK(Uniform1i);
+    GL_CALL_STATS_HOOK(Uniform1ui);
+    GL_CALL_STATS_HOOK(Uniform1f);
+    GL_CALL_STATS_HOOK(Uniform2fv);
+    GL_CALL_STATS_HOOK(Uniform3fv);
+    GL_CALL_STATS_HOOK(Uniform4fv);
+    GL_CALL_STATS_HOOK(UniformMatrix2fv);
+    GL_CALL_STATS_HOOK(UniformMatrix3fv);
+    GL_CALL_STATS_HOOK(UniformMatrix4fv);
+}
+
+#undef GL_CALL_STATS_HOOK
+
+const GLCallCounts& GLCallStats::getCounts() {
+    return counts;
+}
+
+#else
+
+void GLCallStats::install() {}
+
+const GLCallCounts& GLCallStats::getCounts() {
+    static const GLCallCounts zero;
+    return zero;
+}
+
+#endif
+
+const char* GLCallStats::getCategoryName(GLCallCategory category) {
+    switch (category) {
+    case GLCallCategory::Draw: return "draw";
+    case GLCallCategory::ProgramBind: return "program";
+    case GLCallCategory::TextureBind: return "texture";
+    case GLCallCategory::VertexArrayBind: return "vertex_array";
+    case GLCallCategory::UniformUpdate: return "uniform";
+    case GLCallCategory::BufferUpload: return "upload";
+    case GLCallCategory::Count: break;
+    }
+
+    return "unknown";
+}
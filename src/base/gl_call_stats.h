@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+enum class GLCallCategory {
+    Draw,
+    ProgramBind,
+    TextureBind,
+    VertexArrayBind,
+    UniformUpdate,
+    BufferUpload,
+    Count
+};
+
+constexpr int kGLCallCategoryCount = static_cast<int>(GLCallCategory::Count);
+
+struct GLCallCounts {
+    uint64_t calls[kGLCallCategoryCount] = {};
+    // calls that set what was already set: the bound program, texture or vertex array
+    // bound again, or a uniform sent with the value it already had
+    uint64_t redundant[kGLCallCategoryCount] = {};
+    uint64_t uploadBytes = 0;
+
+    uint64_t getCalls(GLCallCategory category) const {
+        return calls[static_cast<int>(category)];
+    }
+
+    uint64_t getRedundant(GLCallCategory category) const {
+        return redundant[static_cast<int>(category)];
+    }
+
+    GLCallCounts& operator+=(const GLCallCounts& rhs) {
+        for (int i = 0; i < kGLCallCategoryCount; ++i) {
+            calls[i] += rhs.calls[i];
+            redundant[i] += rhs.redundant[i];
+        }
+        uploadBytes += rhs.uploadBytes;
+        return *this;
+    }
+
+    GLCallCounts operator-(const GLCallCounts& rhs) const {
+        GLCallCounts difference;
+        for (int i = 0; i < kGLCallCategoryCount; ++i) {
+            difference.calls[i] = calls[i] - rhs.calls[i];
+            difference.redundant[i] = redundant[i] - rhs.redundant[i];
+        }
+        difference.uploadBytes = uploadBytes - rhs.uploadBytes;
+        return difference;
+    }
+};
+
+// GL calls counted by wrappers swapped into glad's function pointers, see gl_call_stats.cpp.
+// Only built in with -DGL_CALL_STATS=ON, otherwise install() does nothing and every count
+// reads zero. Calls made through other loaders (the ImGui backend) are not seen.
+class GLCallStats {
+public:
+    static constexpr bool isEnabled() {
+#ifdef GL_CALL_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // call once, right after gladLoadGL()
+    static void install();
+
+    // counts since install(), render thread only; take differences for a frame or a scope
+    static const GLCallCounts& getCounts();
+
+    static const char* getCategoryName(GLCallCategory category);
+};
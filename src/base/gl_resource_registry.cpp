@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "gl_resource_registry.h"
+
+namespace {
+constexpr size_t kTypeCount = static_cast<size_t>(GLResourceType::Count);
+
+struct Entry {
+    uint64_t bytes = 0;
+    // textures only, the size is recomputed when they get mipmapped
+    size_t texelSize = 0;
+    int width = 0;
+    int height = 0;
+    int layers = 1;
+    bool mipmapped = false;
+};
+
+struct Registry {
+    // keyed by type and handle, GL names are only unique within one object type
+    std::unordered_map<uint64_t, Entry> entries;
+    GLResourceStats stats[kTypeCount];
+    uint32_t frameCreated[kTypeCount] = {};
+    uint32_t frameDeleted[kTypeCount] = {};
+};
+
+Registry& getRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+uint64_t makeKey(GLResourceType type, GLuint handle) {
+    return (static_cast<uint64_t>(type) << 32) | handle;
+}
+
+Entry* findEntry(GLResourceType type, GLuint handle) {
+    Registry& registry = getRegistry();
+    const auto iter = registry.entries.find(makeKey(type, handle));
+    return iter == registry.entries.end() ? nullptr : &iter->second;
+}
+
+void setBytes(GLResourceType type, Entry& entry, uint64_t bytes) {
+    GLResourceStats& stats = getRegistry().stats[static_cast<size_t>(type)];
+    stats.bytes = stats.bytes - entry.bytes + bytes;
+    entry.bytes = bytes;
+}
+
+uint64_t computeTextureBytes(const Entry& entry) {
+    uint64_t bytes = 0;
+    int width = entry.width;
+    int height = entry.height;
+    for (;;) {
+        bytes += static_cast<uint64_t>(width) * height * entry.layers * entry.texelSize;
+        if (!entry.mipmapped || (width <= 1 && height <= 1)) {
+            break;
+        }
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+
+    return bytes;
+}
+} // namespace
+
+void GLResourceRegistry::onCreate(GLResourceType type, GLuint handle) {
+    if (handle == 0) {
+        return;
+    }
+
+    Registry& registry = getRegistry();
+    if (registry.entries.emplace(makeKey(type, handle), Entry()).second) {
+        registry.stats[static_cast<size_t>(type)].live++;
+        registry.frameCreated[static_cast<size_t>(type)]++;
+    }
+}
+
+void GLResourceRegistry::onDelete(GLResourceType type, GLuint handle) {
+    Registry& registry = getRegistry();
+    const auto iter = registry.entries.find(makeKey(type, handle));
+    if (iter == registry.entries.end()) {
+        return;
+    }
+
+    setBytes(type, iter->second, 0);
+    registry.entries.erase(iter);
+    registry.stats[static_cast<size_t>(type)].live--;
+    registry.frameDeleted[static_cast<size_t>(type)]++;
+}
+
+void GLResourceRegistry::setBufferSize(GLuint handle, size_t bytes) {
+    if (Entry* entry = findEntry(GLResourceType::Buffer, handle)) {
+        setBytes(GLResourceType::Buffer, *entry, bytes);
+    }
+}
+
+void GLResourceRegistry::setTextureSize(
+    GLuint handle, GLint internalFormat, int width, int height, int layers) {
+    Entry* entry = findEntry(GLResourceType::Texture, handle);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // new storage for level 0 drops the previously generated levels
+    entry->texelSize = getTexelSize(internalFormat);
+    entry->width = width;
+    entry->height = height;
+    entry->layers = layers;
+    entry->mipmapped = false;
+    setBytes(GLResourceType::Texture, *entry, computeTextureBytes(*entry));
+}
+
+void GLResourceRegistry::setTextureMipmapped(GLuint handle) {
+    Entry* entry = findEntry(GLResourceType::Texture, handle);
+    if (entry == nullptr || entry->mipmapped) {
+        return;
+    }
+
+    entry->mipmapped = true;
+    setBytes(GLResourceType::Texture, *entry, computeTextureBytes(*entry));
+}
+
+void GLResourceRegistry::beginFrame() {
+    Registry& registry = getRegistry();
+    for (size_t i = 0; i < kTypeCount; ++i) {
+        registry.stats[i].created = registry.frameCreated[i];
+        registry.stats[i].deleted = registry.frameDeleted[i];
+        registry.frameCreated[i] = 0;
+        registry.frameDeleted[i] = 0;
+    }
+}
+
+GLResourceStats GLResourceRegistry::getStats(GLResourceType type) {
+    return getRegistry().stats[static_cast<size_t>(type)];
+}
+
+GLResourceStats GLResourceRegistry::getTotalStats() {
+    GLResourceStats total;
+    for (const GLResourceStats& stats : getRegistry().stats) {
+        total.live += stats.live;
+        total.bytes += stats.bytes;
+        total.created += stats.created;
+        total.deleted += stats.deleted;
+    }
+
+    return total;
+}
+
+const char* GLResourceRegistry::getTypeName(GLResourceType type) {
+    switch (type) {
+    case GLResourceType::Buffer: return "buffer";
+    case GLResourceType::Texture: return "texture";
+    case GLResourceType::VertexArray: return "vertex array";
+    case GLResourceType::Framebuffer: return "framebuffer";
+    case GLResourceType::Sampler: return "sampler";
+    case GLResourceType::Program: return "program";
+    case GLResourceType::Query: return "query";
+    case GLResourceType::Count: break;
+    }
+
+    return "unknown";
+}
+
+size_t GLResourceRegistry::getTexelSize(GLint internalFormat) {
+    switch (static_cast<GLenum>(internalFormat)) {
+    case GL_RED:
+    case GL_R8: return 1;
+    case GL_RG:
+    case GL_RG8:
+    case GL_R16F:
+    case GL_DEPTH_COMPONENT16: return 2;
+    case GL_RGB:
+    case GL_RGB8:
+    case GL_SRGB8: return 3;
+    case GL_RGB16F: return 6;
+    case GL_RG32F:
+    case GL_RGBA16F:
+    case GL_DEPTH32F_STENCIL8: return 8;
+    case GL_RGB32F: return 12;
+    case GL_RGBA32F: return 16;
+    // RGBA8, R32F, RG16F, R11F_G11F_B10F and the 24/32 bit depth formats
+    default: return 4;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gl_utility.h"
+
+enum class GLResourceType {
+    Buffer,
+    Texture,
+    VertexArray,
+    Framebuffer,
+    Sampler,
+    Program,
+    Query,
+    Count
+};
+
+struct GLResourceStats {
+    uint32_t live = 0;
+    // estimated from sizes and formats, drivers may pad or compress
+    uint64_t bytes = 0;
+    // during the last complete frame
+    uint32_t created = 0;
+    uint32_t deleted = 0;
+};
+
+// Bookkeeping for the GL objects created by the src/base wrappers: they report creation,
+// storage size and deletion here, the registry keeps live counts, estimated video memory
+// and the churn per frame. GL objects belong to the render thread, so does the registry.
+class GLResourceRegistry {
+public:
+    static void onCreate(GLResourceType type, GLuint handle);
+
+    static void onDelete(GLResourceType type, GLuint handle);
+
+    // replaces the size recorded for the buffer, call after every glBufferData
+    static void setBufferSize(GLuint handle, size_t bytes);
+
+    // level 0 of every layer (or cube face); the rest of the chain is added once mipmapped
+    static void setTextureSize(
+        GLuint handle, GLint internalFormat, int width, int height, int layers = 1);
+
+    // call after glGenerateMipmap
+    static void setTextureMipmapped(GLuint handle);
+
+    // closes the creation and deletion counts of the previous frame
+    static void beginFrame();
+
+    static GLResourceStats getStats(GLResourceType type);
+
+    static GLResourceStats getTotalStats();
+
+    static const char* getTypeName(GLResourceType type);
+
+    static size_t getTexelSize(GLint internalFormat);
+};
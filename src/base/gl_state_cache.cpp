@@ -0,0 +1,101 @@
+#include "gl_state_cache.h"
+
+void GLStateCache::invalidate() {
+    _program = -1;
+    _vertexArray = -1;
+    _activeUnit = -1;
+    for (int i = 0; i < kTextureUnits; ++i) {
+        _texturesKnown[i] = false;
+    }
+    _depthTest = -1;
+    _blend = -1;
+    _cullFace = -1;
+    _depthMask = -1;
+    _depthFunc = 0;
+    _blendSource = 0;
+    _blendDestination = 0;
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (_program != program) {
+        glUseProgram(program);
+        _program = program;
+    }
+}
+
+void GLStateCache::bindTexture(int unit, GLenum target, GLuint texture) {
+    if (unit < 0 || unit >= kTextureUnits) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        _activeUnit = -1;
+        return;
+    }
+
+    TextureBinding& binding = _textures[unit];
+    if (_texturesKnown[unit] && binding.target == target && binding.texture == texture) {
+        return;
+    }
+
+    if (_activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        _activeUnit = unit;
+    }
+    glBindTexture(target, texture);
+    binding = {target, texture};
+    _texturesKnown[unit] = true;
+}
+
+void GLStateCache::bindVertexArray(GLuint vao) {
+    if (_vertexArray != vao) {
+        glBindVertexArray(vao);
+        _vertexArray = vao;
+    }
+}
+
+void GLStateCache::setEnabled(GLenum capability, bool enabled) {
+    int8_t* state = findCapability(capability);
+    if (state != nullptr && *state == static_cast<int8_t>(enabled)) {
+        return;
+    }
+
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+
+    if (state != nullptr) {
+        *state = static_cast<int8_t>(enabled);
+    }
+}
+
+void GLStateCache::setDepthMask(bool enabled) {
+    if (_depthMask != static_cast<int8_t>(enabled)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        _depthMask = static_cast<int8_t>(enabled);
+    }
+}
+
+void GLStateCache::setDepthFunc(GLenum func) {
+    if (_depthFunc != func) {
+        glDepthFunc(func);
+        _depthFunc = func;
+    }
+}
+
+void GLStateCache::setBlendFunc(GLenum source, GLenum destination) {
+    if (_blendSource != source || _blendDestination != destination) {
+        glBlendFunc(source, destination);
+        _blendSource = source;
+        _blendDestination = destination;
+    }
+}
+
+int8_t* GLStateCache::findCapability(GLenum capability) {
+    switch (capability) {
+        case GL_DEPTH_TEST: return &_depthTest;
+        case GL_BLEND: return &_blend;
+        case GL_CULL_FACE: return &_cullFace;
+        default: return nullptr;
+    }
+}
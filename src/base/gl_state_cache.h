@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gl_utility.h"
+
+// Remembers the GL state it set last and drops calls that would set it again. It only knows
+// what went through it: call invalidate() after code that binds or enables things directly.
+class GLStateCache {
+public:
+    static constexpr int kTextureUnits = 8;
+
+    GLStateCache() {
+        invalidate();
+    }
+
+    void invalidate();
+
+    void useProgram(GLuint program);
+
+    void bindTexture(int unit, GLenum target, GLuint texture);
+
+    void bindVertexArray(GLuint vao);
+
+    // GL_DEPTH_TEST, GL_BLEND and GL_CULL_FACE are cached, other capabilities go straight through
+    void setEnabled(GLenum capability, bool enabled);
+
+    void setDepthMask(bool enabled);
+
+    void setDepthFunc(GLenum func);
+
+    void setBlendFunc(GLenum source, GLenum destination);
+
+private:
+    struct TextureBinding {
+        GLenum target;
+        GLuint texture;
+    };
+
+    // -1 while unknown
+    int64_t _program;
+    int64_t _vertexArray;
+    int _activeUnit;
+    TextureBinding _textures[kTextureUnits];
+    bool _texturesKnown[kTextureUnits];
+    int8_t _depthTest;
+    int8_t _blend;
+    int8_t _cullFace;
+    int8_t _depthMask;
+    // 0 while unknown
+    GLenum _depthFunc;
+    GLenum _blendSource;
+    GLenum _blendDestination;
+
+    int8_t* findCapability(GLenum capability);
+};
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <regex>
 #include <sstream>
@@ -6,6 +11,13 @@
 
 #include <glm/ext.hpp>
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "gl_resource_registry.h"
 #include "glsl_program.h"
 
 GLSLProgram::GLSLProgram() {
@@ -13,12 +25,15 @@ GLSLProgram::GLSLProgram() {
     if (_handle == 0) {
         throw std::runtime_error("create glsl program failure");
     }
+    GLResourceRegistry::onCreate(GLResourceType::Program, _handle);
 }
 
 GLSLProgram::GLSLProgram(GLSLProgram&& rhs) noexcept
     : _handle(rhs._handle), _vertexShaders(std::move(rhs._vertexShaders)),
       _geometryShaders(std::move(rhs._geometryShaders)),
-      _fragmentShaders(std::move(rhs._fragmentShaders)) {
+      _fragmentShaders(std::move(rhs._fragmentShaders)), _sources(std::move(rhs._sources)),
+      _compiledSources(rhs._compiledSources), _varyingsKey(std::move(rhs._varyingsKey)),
+      _uniforms(std::move(rhs._uniforms)), _uniformIndices(std::move(rhs._uniformIndices)) {
     rhs._handle = 0;
     rhs._vertexShaders.clear();
     rhs._geometryShaders.clear();
@@ -39,75 +54,228 @@ GLSLProgram::~GLSLProgram() {
     }
 
     if (_handle) {
+        GLResourceRegistry::onDelete(GLResourceType::Program, _handle);
         glDeleteProgram(_handle);
         _handle = 0;
     }
 }
 
 void GLSLProgram::attachVertexShader(const std::string& code) {
-    GLuint vertexShader = createShader(code, GL_VERTEX_SHADER);
-    glAttachShader(_handle, vertexShader);
-    _vertexShaders.push_back(vertexShader);
+    _sources.push_back({GL_VERTEX_SHADER, code, std::string()});
 }
 
 void GLSLProgram::attachGeometryShader(const std::string& code) {
-    GLuint geometryShader = createShader(code, GL_GEOMETRY_SHADER);
-    glAttachShader(_handle, geometryShader);
-    _geometryShaders.push_back(geometryShader);
+    _sources.push_back({GL_GEOMETRY_SHADER, code, std::string()});
 }
 
 void GLSLProgram::attachFragmentShader(const std::string& code) {
-    GLuint fragmentShader = createShader(code, GL_FRAGMENT_SHADER);
-    glAttachShader(_handle, fragmentShader);
-    _fragmentShaders.push_back(fragmentShader);
+    _sources.push_back({GL_FRAGMENT_SHADER, code, std::string()});
 }
 
 void GLSLProgram::attachVertexShaderFromFile(const std::string& filePath) {
-    const std::string& code = readFile(filePath);
-    try {
-        attachVertexShader(code);
-    } catch (const std::runtime_error&) {
-        std::cerr << "Compile " << filePath << " error" << std::endl;
-        throw;
-    }
+    _sources.push_back({GL_VERTEX_SHADER, readFile(filePath), filePath});
 }
 
 void GLSLProgram::attachGeometryShaderFromFile(const std::string& filePath) {
-    const std::string& code = readFile(filePath);
-    try {
-        attachGeometryShader(code);
-    } catch (const std::runtime_error&) {
-        std::cerr << "Compile " << filePath << " error" << std::endl;
-        throw;
-    }
+    _sources.push_back({GL_GEOMETRY_SHADER, readFile(filePath), filePath});
 }
 
 void GLSLProgram::attachFragmentShaderFromFile(const std::string& filePath) {
-    const std::string& code = readFile(filePath);
-    try {
-        attachFragmentShader(code);
-    } catch (const std::runtime_error&) {
-        std::cerr << "Compile " << filePath << " error" << std::endl;
-        throw;
-    }
+    _sources.push_back({GL_FRAGMENT_SHADER, readFile(filePath), filePath});
 }
 
 void GLSLProgram::setTransformFeedbackVaryings(
     const std::vector<const char*>& varyings, GLenum bufferMode) {
     glTransformFeedbackVaryings(
         _handle, static_cast<GLsizei>(varyings.size()), varyings.data(), bufferMode);
+
+    // part of the linked program, so part of the binary cache key as well
+    _varyingsKey = std::to_string(bufferMode);
+    for (const char* varying : varyings) {
+        _varyingsKey += ' ';
+        _varyingsKey += varying;
+    }
 }
 
 void GLSLProgram::link() {
-    glLinkProgram(_handle);
+    const auto start = std::chrono::high_resolution_clock::now();
+    ShaderSetupStats& stats = getMutableSetupStats();
+
+    const std::string cachePath = getBinaryCachePath();
+    if (!cachePath.empty() && loadBinary(cachePath)) {
+        ++stats.fromBinaryCache;
+    } else {
+        compileSources();
+        if (!cachePath.empty()) {
+            glProgramParameteri(_handle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        glLinkProgram(_handle);
+
+        GLint success;
+        glGetProgramiv(_handle, GL_LINK_STATUS, &success);
+        if (!success) {
+            char buffer[1024];
+            glGetProgramInfoLog(_handle, sizeof(buffer), NULL, buffer);
+            throw std::runtime_error("link program error: " + std::string(buffer));
+        }
+
+        if (!cachePath.empty()) {
+            saveBinary(cachePath);
+        }
+    }
+
+    reflectUniforms();
+
+    ++stats.programs;
+    stats.ms += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void GLSLProgram::setBinaryCacheDirectory(const std::string& directory) {
+    getBinaryCacheDirectory() = directory;
+}
+
+const GLSLProgram::ShaderSetupStats& GLSLProgram::getSetupStats() {
+    return getMutableSetupStats();
+}
+
+GLSLProgram::ShaderSetupStats& GLSLProgram::getMutableSetupStats() {
+    static ShaderSetupStats stats;
+    return stats;
+}
+
+std::string& GLSLProgram::getBinaryCacheDirectory() {
+    static std::string directory;
+    return directory;
+}
+
+bool GLSLProgram::isBinaryCacheSupported() {
+    // glad has no entry for GL_ARB_get_program_binary, the 4.1 core entry points are loaded
+    // whenever the driver exposes them; some drivers support no binary format at all
+    static const bool supported = [] {
+        if (glad_glGetProgramBinary == nullptr || glad_glProgramBinary == nullptr ||
+            glad_glProgramParameteri == nullptr) {
+            return false;
+        }
+
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }();
+
+    return supported;
+}
+
+std::string GLSLProgram::getBinaryCachePath() const {
+    const std::string& directory = getBinaryCacheDirectory();
+    if (directory.empty() || _sources.empty() || !isBinaryCacheSupported()) {
+        return std::string();
+    }
+
+    // FNV-1a over the driver identity and everything that goes into the link
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const std::string& text) {
+        for (const char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        hash = (hash ^ 0xffu) * 1099511628211ull;
+    };
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const GLubyte* value = glGetString(name);
+        mix(value ? reinterpret_cast<const char*>(value) : "");
+    }
+    for (const auto& source : _sources) {
+        mix(std::to_string(source.type));
+        mix(source.code);
+    }
+    mix(_varyingsKey);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return directory + "/" + name;
+}
 
+bool GLSLProgram::loadBinary(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    uint32_t header[2] = {};
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(header), sizeof(header)) && header[0] == kBinaryMagic) {
+        binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    if (binary.empty()) {
+        return false;
+    }
+
+    glProgramBinary(_handle, header[1], binary.data(), static_cast<GLsizei>(binary.size()));
     GLint success;
     glGetProgramiv(_handle, GL_LINK_STATUS, &success);
     if (!success) {
-        char buffer[1024];
-        glGetProgramInfoLog(_handle, sizeof(buffer), NULL, buffer);
-        throw std::runtime_error("link program error: " + std::string(buffer));
+        // a driver update or a different gpu, the program is compiled again and the file
+        // overwritten
+        ++getMutableSetupStats().rejectedBinaries;
+        std::cerr << "program binary " << path << " rejected, recompiling" << std::endl;
+        return false;
     }
+
+    return true;
+}
+
+void GLSLProgram::saveBinary(const std::string& path) const {
+    GLint length = 0;
+    glGetProgramiv(_handle, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(_handle, length, nullptr, &format, binary.data());
+
+    makeDirectory(getBinaryCacheDirectory());
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "cannot write program binary " << path << std::endl;
+        return;
+    }
+
+    const uint32_t header[2] = {kBinaryMagic, format};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(binary.data(), binary.size());
+}
+
+void GLSLProgram::compileSources() {
+    for (; _compiledSources < _sources.size(); ++_compiledSources) {
+        const ShaderSource& source = _sources[_compiledSources];
+        GLuint shader;
+        try {
+            shader = createShader(source.code, source.type);
+        } catch (const std::runtime_error&) {
+            if (!source.filePath.empty()) {
+                std::cerr << "Compile " << source.filePath << " error" << std::endl;
+            }
+            throw;
+        }
+
+        glAttachShader(_handle, shader);
+        switch (source.type) {
+        case GL_VERTEX_SHADER: _vertexShaders.push_back(shader); break;
+        case GL_GEOMETRY_SHADER: _geometryShaders.push_back(shader); break;
+        default: _fragmentShaders.push_back(shader); break;
+        }
+    }
+}
+
+void GLSLProgram::makeDirectory(const std::string& directory) {
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
 }
 
 void GLSLProgram::use() {
@@ -153,94 +321,63 @@ int GLSLProgram::getUniformBlockVariableOffset(const std::string& name) const {
     return offset;
 }
 
-void GLSLProgram::setUniformBool(const std::string& name, bool value) const {
+template <typename T>
+void GLSLProgram::setUniformByName(const std::string& name, const T& value) const {
+    const auto iter = _uniformIndices.find(name);
+    if (iter != _uniformIndices.end()) {
+        if (updateCachedValue(iter->second, &value, sizeof(T))) {
+            uploadUniform(_uniforms[iter->second].location, value);
+        }
+        return;
+    }
+
+    // array elements after the first are not in the table
     GLint location = glGetUniformLocation(_handle, name.c_str());
     if (location == -1) {
         std::cerr << "find uniform " + name + " location failure" << std::endl;
     }
 
-    glUniform1i(location, static_cast<int>(value));
+    uploadUniform(location, value);
 }
 
-void GLSLProgram::setUniformInt(const std::string& name, int value) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
+void GLSLProgram::setUniformBool(const std::string& name, bool value) const {
+    setUniformByName(name, value);
+}
 
-    glUniform1i(location, value);
+void GLSLProgram::setUniformInt(const std::string& name, int value) const {
+    setUniformByName(name, value);
 }
 
 void GLSLProgram::setUniformUint(const std::string& name, uint32_t value) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniform1ui(location, value);
+    setUniformByName(name, value);
 }
 
 void GLSLProgram::setUniformFloat(const std::string& name, float value) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniform1f(location, value);
+    setUniformByName(name, value);
 }
 
 void GLSLProgram::setUniformVec2(const std::string& name, const glm::vec2& v2) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniform2fv(location, 1, glm::value_ptr(v2));
+    setUniformByName(name, v2);
 }
 
 void GLSLProgram::setUniformVec3(const std::string& name, const glm::vec3& v3) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniform3fv(location, 1, glm::value_ptr(v3));
+    setUniformByName(name, v3);
 }
 
 void GLSLProgram::setUniformVec4(const std::string& name, const glm::vec4& v4) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniform4fv(location, 1, glm::value_ptr(v4));
+    setUniformByName(name, v4);
 }
 
 void GLSLProgram::setUniformMat2(const std::string& name, const glm::mat2& mat2) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(mat2));
+    setUniformByName(name, mat2);
 }
 
 void GLSLProgram::setUniformMat3(const std::string& name, const glm::mat3& mat3) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(mat3));
+    setUniformByName(name, mat3);
 }
 
 void GLSLProgram::setUniformMat4(const std::string& name, const glm::mat4& mat4) const {
-    GLint location = glGetUniformLocation(_handle, name.c_str());
-    if (location == -1) {
-        std::cerr << "find uniform " + name + " location failure" << std::endl;
-    }
-
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat4));
+    setUniformByName(name, mat4);
 }
 
 void GLSLProgram::setUniformBlockBinding(const std::string& name, uint32_t binding) const {
@@ -252,6 +389,147 @@ void GLSLProgram::setUniformBlockBinding(const std::string& name, uint32_t bindi
     glUniformBlockBinding(_handle, blockIndex, binding);
 }
 
+void GLSLProgram::reflectUniforms() {
+    _uniforms.clear();
+    _uniformIndices.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(_handle, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(std::max(maxLength, 1));
+
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        Uniform uniform;
+        glGetActiveUniform(
+            _handle, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &uniform.type,
+            nameBuffer.data());
+        const std::string name(nameBuffer.data(), length);
+
+        // members of uniform blocks have no location, they live in a buffer
+        uniform.location = glGetUniformLocation(_handle, name.c_str());
+        if (uniform.location < 0) {
+            continue;
+        }
+
+        const int index = static_cast<int>(_uniforms.size());
+        _uniforms.push_back(uniform);
+        _uniformIndices[name] = index;
+
+        // arrays are reported as "name[0]", the plain name sets the first element as well
+        const std::string arraySuffix = "[0]";
+        if (name.size() > arraySuffix.size() &&
+            name.compare(name.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0) {
+            _uniformIndices[name.substr(0, name.size() - arraySuffix.size())] = index;
+        }
+    }
+}
+
+bool GLSLProgram::updateCachedValue(int index, const void* value, size_t size) const {
+    Uniform& uniform = _uniforms[index];
+    if (size > sizeof(uniform.value)) {
+        return true;
+    }
+
+    if (uniform.valueSize == size && std::memcmp(uniform.value, value, size) == 0) {
+        return false;
+    }
+
+    std::memcpy(uniform.value, value, size);
+    uniform.valueSize = size;
+    return true;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, bool) {
+    return type == GL_BOOL;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, int) {
+    switch (type) {
+    case GL_INT:
+    case GL_BOOL:
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_SHADOW:
+    case GL_SAMPLER_CUBE: return true;
+    default: return false;
+    }
+}
+
+bool GLSLProgram::isUniformType(GLenum type, uint32_t) {
+    return type == GL_UNSIGNED_INT;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, float) {
+    return type == GL_FLOAT;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::vec2&) {
+    return type == GL_FLOAT_VEC2;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::vec3&) {
+    return type == GL_FLOAT_VEC3;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::vec4&) {
+    return type == GL_FLOAT_VEC4;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::mat2&) {
+    return type == GL_FLOAT_MAT2;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::mat3&) {
+    return type == GL_FLOAT_MAT3;
+}
+
+bool GLSLProgram::isUniformType(GLenum type, const glm::mat4&) {
+    return type == GL_FLOAT_MAT4;
+}
+
+void GLSLProgram::uploadUniform(GLint location, bool value) {
+    glUniform1i(location, static_cast<int>(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, int value) {
+    glUniform1i(location, value);
+}
+
+void GLSLProgram::uploadUniform(GLint location, uint32_t value) {
+    glUniform1ui(location, value);
+}
+
+void GLSLProgram::uploadUniform(GLint location, float value) {
+    glUniform1f(location, value);
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::vec2& value) {
+    glUniform2fv(location, 1, glm::value_ptr(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::vec3& value) {
+    glUniform3fv(location, 1, glm::value_ptr(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::vec4& value) {
+    glUniform4fv(location, 1, glm::value_ptr(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::mat2& value) {
+    glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::mat3& value) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GLSLProgram::uploadUniform(GLint location, const glm::mat4& value) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
 std::string GLSLProgram::readFile(const std::string& filePath) {
     std::ifstream is;
     is.exceptions(std::ifstream::failbit | std::ifstream::badbit);
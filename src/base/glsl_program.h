@@ -1,12 +1,31 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "gl_utility.h"
 
+// a uniform of a linked program resolved once by name, valid until the program is linked again
+template <typename T>
+class UniformHandle {
+public:
+    UniformHandle() = default;
+
+    bool isValid() const {
+        return _index >= 0;
+    }
+
+private:
+    friend class GLSLProgram;
+
+    explicit UniformHandle(int index) : _index(index) {}
+
+    int _index = -1;
+};
+
 class GLSLProgram {
 public:
     GLSLProgram();
@@ -15,6 +34,8 @@ public:
 
     ~GLSLProgram();
 
+    // sources are only compiled by link(), and not at all when the program binary cache
+    // has the program
     void attachVertexShader(const std::string& code);
 
     void attachGeometryShader(const std::string& filePath);
@@ -31,6 +52,21 @@ public:
 
     void link();
 
+    // linked programs are stored in this directory and loaded from it on later runs, keyed by
+    // the sources and the driver; empty (the default) turns the cache off. Needs
+    // glGetProgramBinary, without it every program is compiled as before.
+    static void setBinaryCacheDirectory(const std::string& directory);
+
+    // every link() so far, including compiling the attached sources
+    struct ShaderSetupStats {
+        int programs = 0;
+        int fromBinaryCache = 0;
+        int rejectedBinaries = 0;
+        double ms = 0.0;
+    };
+
+    static const ShaderSetupStats& getSetupStats();
+
     void use();
 
     void unuse();
@@ -63,6 +99,36 @@ public:
 
     void setUniformBlockBinding(const std::string& name, uint32_t binding) const;
 
+    GLuint getHandle() const {
+        return _handle;
+    }
+
+    // an invalid handle, ignored by setUniform(), when the uniform is not active or T does
+    // not match its type
+    template <typename T>
+    UniformHandle<T> getUniformHandle(const std::string& name) const {
+        const auto iter = _uniformIndices.find(name);
+        if (iter == _uniformIndices.end()) {
+            std::cerr << "find uniform " + name + " location failure" << std::endl;
+            return UniformHandle<T>();
+        }
+
+        if (!isUniformType(_uniforms[iter->second].type, T())) {
+            std::cerr << "uniform " + name + " has another type" << std::endl;
+            return UniformHandle<T>();
+        }
+
+        return UniformHandle<T>(iter->second);
+    }
+
+    // the program must be in use, like for the setters by name
+    template <typename T>
+    void setUniform(UniformHandle<T> handle, const T& value) const {
+        if (handle._index >= 0 && updateCachedValue(handle._index, &value, sizeof(T))) {
+            uploadUniform(_uniforms[handle._index].location, value);
+        }
+    }
+
 private:
     GLuint _handle = 0;
 
@@ -72,7 +138,81 @@ private:
 
     std::vector<GLuint> _fragmentShaders;
 
+    struct ShaderSource {
+        GLenum type;
+        std::string code;
+        // empty for sources given as strings
+        std::string filePath;
+    };
+
+    std::vector<ShaderSource> _sources;
+
+    size_t _compiledSources = 0;
+
+    std::string _varyingsKey;
+
+    static constexpr uint32_t kBinaryMagic = 0x42504c47;  // "GLPB"
+
+    // active uniforms reflected by link() with the value last sent through this class,
+    // so that setting the same value again costs no GL call
+    struct Uniform {
+        GLint location = -1;
+        GLenum type = 0;
+        size_t valueSize = 0;
+        unsigned char value[64];
+    };
+
+    mutable std::vector<Uniform> _uniforms;
+
+    std::unordered_map<std::string, int> _uniformIndices;
+
+    void reflectUniforms();
+
+    // false when the uniform already holds the value
+    bool updateCachedValue(int index, const void* value, size_t size) const;
+
+    template <typename T>
+    void setUniformByName(const std::string& name, const T& value) const;
+
+    static bool isUniformType(GLenum type, bool);
+    static bool isUniformType(GLenum type, int);
+    static bool isUniformType(GLenum type, uint32_t);
+    static bool isUniformType(GLenum type, float);
+    static bool isUniformType(GLenum type, const glm::vec2&);
+    static bool isUniformType(GLenum type, const glm::vec3&);
+    static bool isUniformType(GLenum type, const glm::vec4&);
+    static bool isUniformType(GLenum type, const glm::mat2&);
+    static bool isUniformType(GLenum type, const glm::mat3&);
+    static bool isUniformType(GLenum type, const glm::mat4&);
+
+    static void uploadUniform(GLint location, bool value);
+    static void uploadUniform(GLint location, int value);
+    static void uploadUniform(GLint location, uint32_t value);
+    static void uploadUniform(GLint location, float value);
+    static void uploadUniform(GLint location, const glm::vec2& value);
+    static void uploadUniform(GLint location, const glm::vec3& value);
+    static void uploadUniform(GLint location, const glm::vec4& value);
+    static void uploadUniform(GLint location, const glm::mat2& value);
+    static void uploadUniform(GLint location, const glm::mat3& value);
+    static void uploadUniform(GLint location, const glm::mat4& value);
+
     static std::string readFile(const std::string& filePath);
 
+    void compileSources();
+
+    std::string getBinaryCachePath() const;
+
+    bool loadBinary(const std::string& path);
+
+    void saveBinary(const std::string& path) const;
+
+    static bool isBinaryCacheSupported();
+
+    static std::string& getBinaryCacheDirectory();
+
+    static ShaderSetupStats& getMutableSetupStats();
+
+    static void makeDirectory(const std::string& directory);
+
     static GLuint createShader(const std::string& code, GLenum shaderType);
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include "hitch_detector.h"
+
+constexpr size_t HitchDetector::kMinFrames;
+
+namespace {
+void writeString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+} // namespace
+
+HitchDetector::HitchDetector(size_t capacity) : _frames(std::max<size_t>(capacity, kMinFrames)) {
+    _scratch.reserve(_frames.size());
+}
+
+bool HitchDetector::addFrame(const Profiler& profiler) {
+    // the profiler hands out each resolved frame once, but may be asked again on the same one
+    if (profiler.getLastFrame().empty() || profiler.getLastFrameIndex() == _lastIndex) {
+        return false;
+    }
+    _lastIndex = profiler.getLastFrameIndex();
+
+    Frame& frame = _frames[_next];
+    frame.index = profiler.getLastFrameIndex();
+    frame.wallMs = profiler.getLastFrameWallMs();
+    frame.cpuMs = profiler.getLastFrameCpuMs();
+    frame.samples.assign(profiler.getLastFrame().begin(), profiler.getLastFrame().end());
+    _next = (_next + 1) % _frames.size();
+    _size = std::min(_size + 1, _frames.size());
+
+    if (_size < kMinFrames) {
+        return false;
+    }
+
+    const float medianMs = computeMedianWallMs();
+    const float budgetMs = std::max(_budgetFactor * medianMs, _minBudgetMs);
+    if (frame.wallMs <= budgetMs) {
+        return false;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool rateLimited =
+        _dumpCount >= _maxDumps
+        || (_dumpCount > 0
+            && std::chrono::duration<float>(now - _lastDumpTime).count() < _minSecondsBetweenDumps);
+    if (!rateLimited) {
+        _lastDumpTime = now;
+        dump(frame, medianMs, budgetMs);
+    }
+
+    return true;
+}
+
+float HitchDetector::computeMedianWallMs() {
+    _scratch.clear();
+    for (size_t i = 0; i < _size; ++i) {
+        _scratch.push_back(_frames[i].wallMs);
+    }
+
+    auto middle = _scratch.begin() + _scratch.size() / 2;
+    std::nth_element(_scratch.begin(), middle, _scratch.end());
+    return *middle;
+}
+
+void HitchDetector::dump(const Frame& hitch, float medianMs, float budgetMs) {
+    const std::string path = _pathPrefix + std::to_string(_dumpCount++) + ".json";
+
+    // oldest first
+    auto frames = std::make_shared<std::vector<Frame>>();
+    frames->reserve(_size);
+    for (size_t i = 0; i < _size; ++i) {
+        frames->push_back(_frames[(_next + _frames.size() - _size + i) % _frames.size()]);
+    }
+
+    auto context = std::make_shared<HitchContext>();
+    if (_contextProvider) {
+        *context = _contextProvider();
+    }
+
+    auto write = [path, frames, context, hitchIndex = hitch.index, hitchMs = hitch.wallMs, medianMs,
+                  budgetMs]() {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "open " << path << " for writing failure" << std::endl;
+            return;
+        }
+
+        out << "{\n";
+        out << "  \"hitch\": {\"frame\": " << hitchIndex << ", \"wall_ms\": " << hitchMs
+            << ", \"median_ms\": " << medianMs << ", \"budget_ms\": " << budgetMs << "},\n";
+        out << "  \"context\": {\"game_state\": ";
+        writeString(out, context->gameState);
+        for (const auto& value : context->values) {
+            out << ", ";
+            writeString(out, value.first);
+            out << ": " << value.second;
+        }
+        out << "},\n";
+        out << "  \"frames\": [\n";
+        for (size_t i = 0; i < frames->size(); ++i) {
+            const Frame& frame = (*frames)[i];
+            out << "    {\"frame\": " << frame.index << ", \"wall_ms\": " << frame.wallMs
+                << ", \"cpu_ms\": " << frame.cpuMs << ", \"scopes\": [";
+            for (size_t j = 0; j < frame.samples.size(); ++j) {
+                const Profiler::Sample& sample = frame.samples[j];
+                out << (j == 0 ? "" : ", ") << "{\"name\": ";
+                writeString(out, sample.name);
+                out << ", \"depth\": " << sample.depth << ", \"start_ms\": " << sample.cpuStartMs
+                    << ", \"cpu_ms\": " << sample.cpuMs;
+                if (sample.gpuMs >= 0.0f) {
+                    out << ", \"gpu_ms\": " << sample.gpuMs;
+                }
+                if (AllocationTracker::isEnabled()) {
+                    out << ", \"allocations\": " << sample.allocations.allocations;
+                }
+                out << "}";
+            }
+            out << "]}" << (i + 1 < frames->size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+
+        std::cout << "hitch of " << hitchMs << " ms (median " << medianMs << " ms) written to "
+                  << path << std::endl;
+    };
+
+    // the dump must not cause the next hitch
+    if (_jobSystem != nullptr) {
+        _jobSystem->schedule(write);
+    } else {
+        write();
+    }
+}
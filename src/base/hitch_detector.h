@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "job_system.h"
+#include "profiler.h"
+
+// What the game was doing when a hitch happened, gathered only when a dump is written.
+struct HitchContext {
+    std::string gameState;
+    std::vector<std::pair<std::string, double>> values;
+};
+
+// Keeps the scope timings of the last few hundred frames. When a frame takes longer than
+// budgetFactor times the median of the ring (and at least minBudgetMs), the ring is written
+// to <pathPrefix><n>.json together with a HitchContext. Dumps are rate limited and written
+// on a worker when a job system is given.
+class HitchDetector {
+public:
+    using ContextProvider = std::function<HitchContext()>;
+
+    explicit HitchDetector(size_t capacity = 300);
+
+    void setBudget(float budgetFactor, float minBudgetMs) {
+        _budgetFactor = budgetFactor;
+        _minBudgetMs = minBudgetMs;
+    }
+
+    void setRateLimit(float minSecondsBetweenDumps, int maxDumps) {
+        _minSecondsBetweenDumps = minSecondsBetweenDumps;
+        _maxDumps = maxDumps;
+    }
+
+    void setPathPrefix(const std::string& pathPrefix) {
+        _pathPrefix = pathPrefix;
+    }
+
+    void setContextProvider(ContextProvider provider) {
+        _contextProvider = std::move(provider);
+    }
+
+    void setJobSystem(JobSystem* jobSystem) {
+        _jobSystem = jobSystem;
+    }
+
+    // feed the frame the profiler resolved last; returns true when it was a hitch
+    bool addFrame(const Profiler& profiler);
+
+    int getDumpCount() const {
+        return _dumpCount;
+    }
+
+private:
+    struct Frame {
+        uint64_t index = 0;
+        float wallMs = 0.0f;
+        float cpuMs = 0.0f;
+        std::vector<Profiler::Sample> samples;
+    };
+
+    // frames that have not seen a median yet are not judged
+    static constexpr size_t kMinFrames = 30;
+
+    std::vector<Frame> _frames;
+    size_t _next = 0;
+    size_t _size = 0;
+    uint64_t _lastIndex = std::numeric_limits<uint64_t>::max();
+    std::vector<float> _scratch;
+
+    float _budgetFactor = 2.0f;
+    float _minBudgetMs = 20.0f;
+    float _minSecondsBetweenDumps = 30.0f;
+    int _maxDumps = 20;
+    int _dumpCount = 0;
+    std::chrono::steady_clock::time_point _lastDumpTime;
+    std::string _pathPrefix = "hitch_";
+
+    ContextProvider _contextProvider;
+    JobSystem* _jobSystem = nullptr;
+
+    float computeMedianWallMs();
+
+    void dump(const Frame& hitch, float medianMs, float budgetMs);
+};
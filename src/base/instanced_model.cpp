@@ -1,4 +1,6 @@
+#include "gl_resource_registry.h"
 #include "instanced_model.h"
+#include "normal_matrix.h"
 #include <iostream>
 
 InstancedModel::InstancedModel(
@@ -11,6 +13,8 @@ InstancedModel::InstancedModel(
     glBufferData(
         GL_ARRAY_BUFFER, _modelMatrices.size() * sizeof(glm::mat4), _modelMatrices.data(),
         GL_STATIC_DRAW);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _instanceVbo);
+    GLResourceRegistry::setBufferSize(_instanceVbo, _modelMatrices.size() * sizeof(glm::mat4));
 
     constexpr GLsizei stride = sizeof(glm::mat4);
     constexpr GLsizei unitSize = sizeof(glm::vec4);
@@ -28,6 +32,26 @@ InstancedModel::InstancedModel(
     glVertexAttribDivisor(5, 1);
     glVertexAttribDivisor(6, 1);
 
+    // per instance normal matrices at 7-9, computed once here instead of per vertex
+    std::vector<glm::mat3> normalMatrices(_modelMatrices.size());
+    computeNormalMatrices(_modelMatrices.data(), normalMatrices.data(), _modelMatrices.size());
+
+    glGenBuffers(1, &_normalMatrixVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _normalMatrixVbo);
+    glBufferData(
+        GL_ARRAY_BUFFER, normalMatrices.size() * sizeof(glm::mat3), normalMatrices.data(),
+        GL_STATIC_DRAW);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _normalMatrixVbo);
+    GLResourceRegistry::setBufferSize(_normalMatrixVbo, normalMatrices.size() * sizeof(glm::mat3));
+
+    constexpr GLsizei normalStride = sizeof(glm::mat3);
+    constexpr GLsizei normalUnitSize = sizeof(glm::vec3);
+    for (GLuint i = 0; i < 3; ++i) {
+        glEnableVertexAttribArray(7 + i);
+        glVertexAttribPointer(7 + i, 3, GL_FLOAT, GL_FALSE, normalStride, (void*)(size_t(i) * normalUnitSize));
+        glVertexAttribDivisor(7 + i, 1);
+    }
+
     glBindVertexArray(0);
 
     glBindVertexArray(_boxVao);
@@ -51,15 +75,23 @@ InstancedModel::InstancedModel(
 }
 
 InstancedModel::InstancedModel(InstancedModel&& rhs) noexcept
-    : Model(std::move(rhs)), _instanceVbo(rhs._instanceVbo) {
+    : Model(std::move(rhs)), _instanceVbo(rhs._instanceVbo), _normalMatrixVbo(rhs._normalMatrixVbo) {
     rhs._instanceVbo = 0;
+    rhs._normalMatrixVbo = 0;
 }
 
 InstancedModel::~InstancedModel() {
     if (_instanceVbo) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _instanceVbo);
         glDeleteBuffers(1, &_instanceVbo);
         _instanceVbo = 0;
     }
+
+    if (_normalMatrixVbo) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _normalMatrixVbo);
+        glDeleteBuffers(1, &_normalMatrixVbo);
+        _normalMatrixVbo = 0;
+    }
 }
 
 int InstancedModel::getInstanceCount() const {
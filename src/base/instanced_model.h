@@ -33,4 +33,6 @@ public:
 private:
     std::vector<glm::mat4> _modelMatrices;
     GLuint _instanceVbo = {};
+    // mat3 per instance at attributes 7-9, see computeNormalMatrices()
+    GLuint _normalMatrixVbo = {};
 };
\ No newline at end of file
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <exception>
+
+#include "job_system.h"
+#include "tracer.h"
+
+struct JobSystem::Job {
+    JobFunction function;
+    std::atomic<int> pendingDependencies{1};
+    std::atomic<bool> finished{false};
+    std::exception_ptr error;
+    // queued for executeMainThreadJobs() instead of the workers
+    bool mainThread = false;
+
+    std::mutex mutex;
+    std::vector<JobHandle> dependents;
+
+    // keeps the job alive while only the raw pointer sits in a queue
+    JobHandle self;
+};
+
+namespace {
+thread_local const JobSystem* tlsJobSystem = nullptr;
+thread_local int tlsWorkerIndex = -1;
+thread_local uint32_t tlsRandomState = 0x9e3779b9u;
+
+uint32_t nextRandom() {
+    // xorshift32, only used to pick steal victims
+    uint32_t x = tlsRandomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    tlsRandomState = x;
+    return x;
+}
+} // namespace
+
+bool JobSystem::WorkStealingDeque::push(Job* job) {
+    const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+    const int64_t top = _top.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) {
+        return false;
+    }
+
+    _jobs[bottom & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job* JobSystem::WorkStealingDeque::pop() {
+    const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = _top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = _jobs[bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // last job in the deque, race the thieves for it
+        if (!_top.compare_exchange_strong(
+                top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+JobSystem::Job* JobSystem::WorkStealingDeque::steal() {
+    int64_t top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = _bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    Job* job = _jobs[top & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    return job;
+}
+
+JobSystem::JobSystem(int workerCount) {
+    if (workerCount < 0) {
+        workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        _deques.emplace_back(new WorkStealingDeque);
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        _workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    _running.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _wakeCondition.notify_all();
+    }
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+
+    // finish what is left so that no job leaks through its self reference
+    while (Job* job = findJob()) {
+        execute(job);
+    }
+}
+
+int JobSystem::getWorkerCount() const {
+    return static_cast<int>(_workers.size());
+}
+
+JobSystem::JobHandle JobSystem::schedule(
+    JobFunction function, const std::vector<JobHandle>& dependencies) {
+    return createJob(std::move(function), false, dependencies);
+}
+
+JobSystem::JobHandle JobSystem::createJob(
+    JobFunction function, bool mainThread, const std::vector<JobHandle>& dependencies) {
+    JobHandle job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->mainThread = mainThread;
+
+    for (const auto& dependency : dependencies) {
+        if (!dependency) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (!dependency->finished.load(std::memory_order_relaxed)) {
+            job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+            dependency->dependents.push_back(job);
+        }
+    }
+
+    // drop the reference that guarded the registration above
+    if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        enqueue(job);
+    }
+
+    return job;
+}
+
+bool JobSystem::isFinished(const JobHandle& job) const {
+    return !job || job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    if (!job) {
+        return;
+    }
+
+    while (!job->finished.load(std::memory_order_acquire)) {
+        if (Job* other = findJob()) {
+            execute(other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void JobSystem::parallelFor(
+    size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+
+    // a few batches per thread so that stealing can even out uneven batches
+    const size_t maxBatches = 4 * (_workers.size() + 1);
+    const size_t batchSize = std::max(std::max<size_t>(minBatchSize, 1), (count + maxBatches - 1) / maxBatches);
+    if (batchSize >= count) {
+        function(0, count);
+        return;
+    }
+
+    std::vector<JobHandle> batches;
+    for (size_t begin = batchSize; begin < count; begin += batchSize) {
+        const size_t end = std::min(begin + batchSize, count);
+        batches.push_back(schedule([&function, begin, end]() { function(begin, end); }));
+    }
+
+    // the calling thread takes the first batch instead of idling
+    std::exception_ptr error;
+    try {
+        function(0, batchSize);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    // every batch references function, so all of them must be done before leaving
+    for (const auto& batch : batches) {
+        try {
+            wait(batch);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+JobSystem::JobHandle JobSystem::runOnMainThread(
+    JobFunction function, const std::vector<JobHandle>& dependencies) {
+    return createJob(std::move(function), true, dependencies);
+}
+
+void JobSystem::executeMainThreadJobs() {
+    std::vector<JobHandle> jobs;
+    {
+        std::lock_guard<std::mutex> lock(_mainThreadMutex);
+        jobs.swap(_mainThreadJobs);
+    }
+
+    // a failure stays in the job for whoever waits on it
+    for (const auto& job : jobs) {
+        execute(job.get());
+    }
+}
+
+void JobSystem::waitOnMainThread(const JobHandle& job) {
+    if (!job) {
+        return;
+    }
+
+    while (!job->finished.load(std::memory_order_acquire)) {
+        executeMainThreadJobs();
+        if (Job* other = findJob()) {
+            execute(other);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+void JobSystem::workerLoop(int workerIndex) {
+    tlsJobSystem = this;
+    tlsWorkerIndex = workerIndex;
+    tlsRandomState += static_cast<uint32_t>(workerIndex) * 0x85ebca6bu;
+    Tracer::setThreadName("worker " + std::to_string(workerIndex));
+
+    while (_running.load(std::memory_order_acquire)) {
+        if (Job* job = findJob()) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepingWorkers.fetch_add(1);
+        _wakeCondition.wait(lock, [this]() {
+            return _queuedJobs.load() > 0 || !_running.load(std::memory_order_acquire);
+        });
+        _sleepingWorkers.fetch_sub(1);
+    }
+
+    tlsJobSystem = nullptr;
+    tlsWorkerIndex = -1;
+}
+
+void JobSystem::enqueue(const JobHandle& job) {
+    // the handle in the queue keeps a main thread job alive, the workers never see it
+    if (job->mainThread) {
+        std::lock_guard<std::mutex> lock(_mainThreadMutex);
+        _mainThreadJobs.push_back(job);
+        return;
+    }
+
+    job->self = job;
+
+    const int workerIndex = tlsJobSystem == this ? tlsWorkerIndex : -1;
+    if (workerIndex < 0 || !_deques[workerIndex]->push(job.get())) {
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        _injectionQueue.push_back(job.get());
+    }
+
+    _queuedJobs.fetch_add(1);
+    if (_sleepingWorkers.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _wakeCondition.notify_one();
+    }
+}
+
+JobSystem::Job* JobSystem::findJob() {
+    const int workerIndex = tlsJobSystem == this ? tlsWorkerIndex : -1;
+
+    Job* job = nullptr;
+    if (workerIndex >= 0) {
+        job = _deques[workerIndex]->pop();
+    }
+
+    if (job == nullptr) {
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        if (!_injectionQueue.empty()) {
+            job = _injectionQueue.front();
+            _injectionQueue.pop_front();
+        }
+    }
+
+    if (job == nullptr && !_deques.empty()) {
+        const size_t start = nextRandom() % _deques.size();
+        for (size_t i = 0; i < _deques.size() && job == nullptr; ++i) {
+            const size_t victim = (start + i) % _deques.size();
+            if (static_cast<int>(victim) != workerIndex) {
+                job = _deques[victim]->steal();
+            }
+        }
+    }
+
+    if (job != nullptr) {
+        _queuedJobs.fetch_sub(1);
+    }
+
+    return job;
+}
+
+void JobSystem::execute(Job* job) {
+    try {
+        TRACE_SCOPE("job");
+        job->function();
+    } catch (...) {
+        job->error = std::current_exception();
+    }
+
+    // release the captures before anyone waiting on the job continues
+    job->function = nullptr;
+
+    JobHandle keepAlive = std::move(job->self);
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+
+    for (const auto& dependent : dependents) {
+        if (dependent->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            enqueue(dependent);
+        }
+    }
+}
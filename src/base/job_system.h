@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Every worker owns a Chase-Lev deque: it pushes and pops jobs at the bottom while idle
+// workers steal from the top. Threads that are not workers (the main thread, the
+// simulation thread) submit through a shared injection queue and help execute jobs
+// while they wait. GL calls are only legal on the main thread, so GL work is scheduled
+// with runOnMainThread() and waited for with waitOnMainThread().
+class JobSystem {
+public:
+    using JobFunction = std::function<void()>;
+
+    struct Job;
+
+    using JobHandle = std::shared_ptr<Job>;
+
+    // workerCount < 0 uses one worker per hardware thread besides the calling thread
+    explicit JobSystem(int workerCount = -1);
+
+    JobSystem(const JobSystem&) = delete;
+
+    ~JobSystem();
+
+    int getWorkerCount() const;
+
+    // the job starts once all of its dependencies have finished
+    JobHandle schedule(JobFunction function, const std::vector<JobHandle>& dependencies = {});
+
+    bool isFinished(const JobHandle& job) const;
+
+    // executes other jobs until the job has finished, rethrows an exception the job threw
+    void wait(const JobHandle& job);
+
+    // calls function(begin, end) over sub ranges of [0, count) and returns when all are done
+    void parallelFor(
+        size_t count, size_t minBatchSize, const std::function<void(size_t, size_t)>& function);
+
+    // a job that runs on the main thread once its dependencies have finished, e.g. the gl
+    // upload of an asset loaded by a dependency; errors end up in the handle as for schedule()
+    JobHandle runOnMainThread(JobFunction function, const std::vector<JobHandle>& dependencies = {});
+
+    // call from the main thread, runs all main thread jobs that are ready
+    void executeMainThreadJobs();
+
+    // call from the main thread, wait() that also runs main thread jobs, which a job may
+    // depend on
+    void waitOnMainThread(const JobHandle& job);
+
+private:
+    // fixed capacity Chase-Lev deque, see "Correct and Efficient Work-Stealing for Weak
+    // Memory Models" (Le et al. 2013)
+    class WorkStealingDeque {
+    public:
+        bool push(Job* job);
+
+        Job* pop();
+
+        Job* steal();
+
+    private:
+        static constexpr int64_t kCapacity = 4096;
+
+        // thieves hammer _top, keep it off the cache line of the owner's _bottom
+        std::atomic<int64_t> _top{0};
+        char _padding[64 - sizeof(std::atomic<int64_t>)];
+        std::atomic<int64_t> _bottom{0};
+        std::atomic<Job*> _jobs[kCapacity];
+    };
+
+    std::vector<std::thread> _workers;
+    std::vector<std::unique_ptr<WorkStealingDeque>> _deques;
+
+    std::mutex _injectionMutex;
+    std::deque<Job*> _injectionQueue;
+
+    std::mutex _mainThreadMutex;
+    std::vector<JobHandle> _mainThreadJobs;
+
+    // sleeping workers wait for _queuedJobs > 0
+    std::atomic<bool> _running{true};
+    std::atomic<int> _queuedJobs{0};
+    std::atomic<int> _sleepingWorkers{0};
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeCondition;
+
+    void workerLoop(int workerIndex);
+
+    JobHandle createJob(JobFunction function, bool mainThread, const std::vector<JobHandle>& dependencies);
+
+    void enqueue(const JobHandle& job);
+
+    Job* findJob();
+
+    void execute(Job* job);
+};
@@ -7,9 +7,29 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "gl_resource_registry.h"
 #include "model.h"
 
+uint32_t Model::_drawCount = 0;
+
 Model::Model(const std::string& filepath) {
+    importMesh(filepath, _vertices, _indices);
+
+    computeBoundingBox();
+
+    initGLResources();
+
+    initBoxGLResources();
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        cleanup();
+        throw std::runtime_error("OpenGL Error: " + std::to_string(error));
+    }
+}
+
+void Model::importMesh(const std::string& filepath, std::vector<Vertex>& vertices,
+                       std::vector<uint32_t>& indices) {
     Assimp::Importer importer;
     
     // 设置后处理选项
@@ -23,27 +43,10 @@ Model::Model(const std::string& filepath) {
         throw std::runtime_error("Failed to load model: " + std::string(importer.GetErrorString()));
     }
     
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
     std::unordered_map<Vertex, uint32_t> uniqueVertices;
     
     // 处理所有网格
     processNode(scene->mRootNode, scene, vertices, indices, uniqueVertices);
-    
-    _vertices = vertices;
-    _indices = indices;
-
-    computeBoundingBox();
-
-    initGLResources();
-
-    initBoxGLResources();
-
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        cleanup();
-        throw std::runtime_error("OpenGL Error: " + std::to_string(error));
-    }
 }
 
 void Model::processNode(aiNode* node, const aiScene* scene, 
@@ -66,6 +69,9 @@ void Model::processMesh(aiMesh* mesh, const aiScene* scene,
                        std::vector<Vertex>& vertices, 
                        std::vector<uint32_t>& indices,
                        std::unordered_map<Vertex, uint32_t>& uniqueVertices) {
+    std::vector<Vertex> meshVertices;
+    meshVertices.reserve(mesh->mNumVertices);
+
     // 处理顶点
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
         Vertex vertex{};
@@ -90,40 +96,38 @@ void Model::processMesh(aiMesh* mesh, const aiScene* scene,
             vertex.texCoord = glm::vec2(0.0f, 0.0f);
         }
         
-        // 检查顶点是否已存在以减少冗余数据
-        if (uniqueVertices.count(vertex) == 0) {
-            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-            vertices.push_back(vertex);
-        }
+        meshVertices.push_back(vertex);
     }
     
     // 处理索引
+    std::vector<uint32_t> cornerIndices;
+    cornerIndices.reserve(3 * mesh->mNumFaces);
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-        aiFace face = mesh->mFaces[i];
+        const aiFace& face = mesh->mFaces[i];
         for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            Vertex vertex{};
-            
-            // 获取顶点数据
-            vertex.position.x = mesh->mVertices[face.mIndices[j]].x;
-            vertex.position.y = mesh->mVertices[face.mIndices[j]].y;
-            vertex.position.z = mesh->mVertices[face.mIndices[j]].z;
-            
-            if (mesh->HasNormals()) {
-                vertex.normal.x = mesh->mNormals[face.mIndices[j]].x;
-                vertex.normal.y = mesh->mNormals[face.mIndices[j]].y;
-                vertex.normal.z = mesh->mNormals[face.mIndices[j]].z;
-            }
-            
-            if (mesh->mTextureCoords[0]) {
-                vertex.texCoord.x = mesh->mTextureCoords[0][face.mIndices[j]].x;
-                vertex.texCoord.y = mesh->mTextureCoords[0][face.mIndices[j]].y;
-            } else {
-                vertex.texCoord = glm::vec2(0.0f, 0.0f);
-            }
-            
-            indices.push_back(uniqueVertices[vertex]);
+            cornerIndices.push_back(face.mIndices[j]);
         }
     }
+
+    weldVertices(meshVertices, cornerIndices, vertices, indices, uniqueVertices);
+}
+
+void Model::weldVertices(const std::vector<Vertex>& meshVertices,
+                         const std::vector<uint32_t>& cornerIndices,
+                         std::vector<Vertex>& vertices,
+                         std::vector<uint32_t>& indices,
+                         std::unordered_map<Vertex, uint32_t>& uniqueVertices) {
+    // 检查顶点是否已存在以减少冗余数据
+    for (const Vertex& vertex : meshVertices) {
+        if (uniqueVertices.count(vertex) == 0) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(vertex);
+        }
+    }
+
+    for (uint32_t index : cornerIndices) {
+        indices.push_back(uniqueVertices[meshVertices[index]]);
+    }
 }
 
 Model::Model(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
@@ -164,10 +168,15 @@ BoundingBox Model::getBoundingBox() const {
 
 void Model::draw() const {
     glBindVertexArray(_vao);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_indices.size()), GL_UNSIGNED_INT, 0);
+    drawBound();
     glBindVertexArray(0);
 }
 
+void Model::drawBound() const {
+    ++_drawCount;
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_indices.size()), GL_UNSIGNED_INT, 0);
+}
+
 void Model::drawBoundingBox() const {
     glBindVertexArray(_boxVao);
     glDrawElements(GL_LINES, 24, GL_UNSIGNED_INT, 0);
@@ -208,6 +217,12 @@ void Model::initGLResources() {
         GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(uint32_t), _indices.data(),
         GL_STATIC_DRAW);
 
+    GLResourceRegistry::onCreate(GLResourceType::VertexArray, _vao);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _vbo);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _ebo);
+    GLResourceRegistry::setBufferSize(_vbo, sizeof(Vertex) * _vertices.size());
+    GLResourceRegistry::setBufferSize(_ebo, _indices.size() * sizeof(uint32_t));
+
     // specify layout, size of a vertex, data type, normalize, sizeof vertex array, offset of the
     // attribute
     glVertexAttribPointer(
@@ -274,6 +289,12 @@ void Model::initBoxGLResources() {
         GL_ELEMENT_ARRAY_BUFFER, boxIndices.size() * sizeof(uint32_t), boxIndices.data(),
         GL_STATIC_DRAW);
 
+    GLResourceRegistry::onCreate(GLResourceType::VertexArray, _boxVao);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _boxVbo);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _boxEbo);
+    GLResourceRegistry::setBufferSize(_boxVbo, boxVertices.size() * sizeof(glm::vec3));
+    GLResourceRegistry::setBufferSize(_boxEbo, boxIndices.size() * sizeof(uint32_t));
+
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0);
     glEnableVertexAttribArray(0);
 
@@ -282,38 +303,66 @@ void Model::initBoxGLResources() {
 
 void Model::cleanup() {
     if (_boxEbo) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _boxEbo);
         glDeleteBuffers(1, &_boxEbo);
         _boxEbo = 0;
     }
 
     if (_boxVbo) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _boxVbo);
         glDeleteBuffers(1, &_boxVbo);
         _boxVbo = 0;
     }
 
     if (_boxVao) {
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, _boxVao);
         glDeleteVertexArrays(1, &_boxVao);
         _boxVao = 0;
     }
 
     if (_ebo != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _ebo);
         glDeleteBuffers(1, &_ebo);
         _ebo = 0;
     }
 
     if (_vbo != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _vbo);
         glDeleteBuffers(1, &_vbo);
         _vbo = 0;
     }
 
     if (_vao != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, _vao);
         glDeleteVertexArrays(1, &_vao);
         _vao = 0;
     }
 }
 Model Model::interpolateModel(const Model& m1, const Model& m2, float t) {
-    const auto& v1 = m1.getVertices();
-    const auto& v2 = m2.getVertices();
+    return Model(interpolateVertices(m1.getVertices(), m2.getVertices(), t), m1.getIndices());
+}
+
+void Model::setMorphTarget(const Model& target) {
+    if (target._vertices.size() != _vertices.size()) {
+        throw std::runtime_error("Model vertex count mismatch!");
+    }
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, target._vbo);
+    glVertexAttribPointer(
+        10, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+    glEnableVertexAttribArray(10);
+    glVertexAttribPointer(
+        11, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glEnableVertexAttribArray(11);
+    glVertexAttribPointer(
+        12, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glEnableVertexAttribArray(12);
+    glBindVertexArray(0);
+}
+
+std::vector<Vertex> Model::interpolateVertices(
+    const std::vector<Vertex>& v1, const std::vector<Vertex>& v2, float t) {
     std::vector<Vertex> interpolatedVertices;
 
     if (v1.size() != v2.size()) {
@@ -328,5 +377,5 @@ Model Model::interpolateModel(const Model& m1, const Model& m2, float t) {
         interpolatedVertices.push_back(v);
     }
 
-    return Model(interpolatedVertices, m1.getIndices());
+    return interpolatedVertices;
 }
@@ -36,8 +36,21 @@ public:
 
     virtual void draw() const;
 
+    // draws with whatever vertex array is bound, for callers that bind getVao() themselves
+    // and skip the bind and unbind around every draw (see RenderQueue)
+    void drawBound() const;
+
     virtual void drawBoundingBox() const;
 
+    // draw() calls since the last resetDrawCount(), render thread only
+    static uint32_t getDrawCount() {
+        return _drawCount;
+    }
+
+    static void resetDrawCount() {
+        _drawCount = 0;
+    }
+
     const std::vector<uint32_t>& getIndices() const {
         return _indices;
     }
@@ -49,6 +62,27 @@ public:
     }
     Model interpolateModel(const Model& m1, const Model& m2, float t);
 
+    // feeds target's vertices to attributes 10-12 of this model's vertex array, for shaders
+    // that blend toward them on the gpu (MORPH); target must have the same vertex count
+    // and outlive this model
+    void setMorphTarget(const Model& target);
+
+    // the cpu half of interpolateModel, blends two vertex arrays of the same topology
+    static std::vector<Vertex> interpolateVertices(
+        const std::vector<Vertex>& v1, const std::vector<Vertex>& v2, float t);
+
+    // appends the mesh to vertices/indices, reusing vertices already in uniqueVertices;
+    // cornerIndices index into meshVertices, three per triangle
+    static void weldVertices(const std::vector<Vertex>& meshVertices,
+                             const std::vector<uint32_t>& cornerIndices,
+                             std::vector<Vertex>& vertices,
+                             std::vector<uint32_t>& indices,
+                             std::unordered_map<Vertex, uint32_t>& uniqueVertices);
+
+    // imports and welds the mesh without touching GL, safe to call on a worker thread
+    static void importMesh(const std::string& filepath, std::vector<Vertex>& vertices,
+                           std::vector<uint32_t>& indices);
+
 public:
     Transform transform;
 
@@ -69,6 +103,8 @@ protected:
     GLuint _boxVbo = 0;
     GLuint _boxEbo = 0;
 
+    static uint32_t _drawCount;
+
     void computeBoundingBox();
 
     void initGLResources();
@@ -78,12 +114,12 @@ protected:
     void cleanup();
     
     // assimp相关的辅助函数
-    void processNode(aiNode* node, const aiScene* scene, 
+    static void processNode(aiNode* node, const aiScene* scene, 
                     std::vector<Vertex>& vertices, 
                     std::vector<uint32_t>& indices,
                     std::unordered_map<Vertex, uint32_t>& uniqueVertices);
     
-    void processMesh(aiMesh* mesh, const aiScene* scene,
+    static void processMesh(aiMesh* mesh, const aiScene* scene,
                     std::vector<Vertex>& vertices, 
                     std::vector<uint32_t>& indices,
                     std::unordered_map<Vertex, uint32_t>& uniqueVertices);
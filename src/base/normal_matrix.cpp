@@ -0,0 +1,109 @@
+#include <cmath>
+
+#include "normal_matrix.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NORMAL_MATRIX_SSE
+#endif
+
+namespace {
+constexpr float kUniformScaleTolerance = 1e-4f;
+
+// columns of the same length at right angles, within a tolerance relative to that length
+bool isUniformScale(float len0, float len1, float len2, float dot01, float dot12, float dot20) {
+    const float tolerance = kUniformScaleTolerance * len0;
+    return std::abs(len1 - len0) <= tolerance && std::abs(len2 - len0) <= tolerance &&
+           std::abs(dot01) <= tolerance && std::abs(dot12) <= tolerance &&
+           std::abs(dot20) <= tolerance;
+}
+}  // namespace
+
+glm::mat3 computeNormalMatrix(const glm::mat4& model) {
+    const glm::vec3 c0(model[0]);
+    const glm::vec3 c1(model[1]);
+    const glm::vec3 c2(model[2]);
+
+    const float len0 = glm::dot(c0, c0);
+    if (isUniformScale(
+            len0, glm::dot(c1, c1), glm::dot(c2, c2), glm::dot(c0, c1), glm::dot(c1, c2),
+            glm::dot(c2, c0))) {
+        return len0 > 0.0f ? glm::mat3(c0, c1, c2) / len0 : glm::mat3(1.0f);
+    }
+
+    // the columns of the inverse transpose are the cross products of the other two
+    // columns over the determinant
+    const glm::vec3 r0 = glm::cross(c1, c2);
+    const float det = glm::dot(c0, r0);
+    if (det == 0.0f) {
+        return glm::mat3(c0, c1, c2);
+    }
+
+    return glm::mat3(r0, glm::cross(c2, c0), glm::cross(c0, c1)) / det;
+}
+
+#ifdef NORMAL_MATRIX_SSE
+namespace {
+inline __m128 cross(__m128 a, __m128 b) {
+    const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+inline float dot(__m128 a, __m128 b) {
+    const __m128 product = _mm_mul_ps(a, b);
+    const __m128 y = _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z = _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2));
+    return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(product, y), z));
+}
+
+inline void storeColumn(glm::mat3& matrix, int column, __m128 value) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, value);
+    matrix[column] = glm::vec3(lanes[0], lanes[1], lanes[2]);
+}
+}  // namespace
+
+void computeNormalMatrices(const glm::mat4* models, glm::mat3* normalMatrices, size_t count) {
+    // w is dropped so that it never leaks into the dot and cross products
+    const __m128 xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (size_t i = 0; i < count; ++i) {
+        const float* m = &models[i][0][0];
+        const __m128 c0 = _mm_and_ps(_mm_loadu_ps(m), xyzMask);
+        const __m128 c1 = _mm_and_ps(_mm_loadu_ps(m + 4), xyzMask);
+        const __m128 c2 = _mm_and_ps(_mm_loadu_ps(m + 8), xyzMask);
+        glm::mat3& result = normalMatrices[i];
+
+        const float len0 = dot(c0, c0);
+        if (isUniformScale(
+                len0, dot(c1, c1), dot(c2, c2), dot(c0, c1), dot(c1, c2), dot(c2, c0))) {
+            const __m128 inverse = _mm_set1_ps(len0 > 0.0f ? 1.0f / len0 : 1.0f);
+            storeColumn(result, 0, _mm_mul_ps(c0, inverse));
+            storeColumn(result, 1, _mm_mul_ps(c1, inverse));
+            storeColumn(result, 2, _mm_mul_ps(c2, inverse));
+            continue;
+        }
+
+        const __m128 r0 = cross(c1, c2);
+        const float det = dot(c0, r0);
+        if (det == 0.0f) {
+            storeColumn(result, 0, c0);
+            storeColumn(result, 1, c1);
+            storeColumn(result, 2, c2);
+            continue;
+        }
+
+        const __m128 inverse = _mm_set1_ps(1.0f / det);
+        storeColumn(result, 0, _mm_mul_ps(r0, inverse));
+        storeColumn(result, 1, _mm_mul_ps(cross(c2, c0), inverse));
+        storeColumn(result, 2, _mm_mul_ps(cross(c0, c1), inverse));
+    }
+}
+#else
+void computeNormalMatrices(const glm::mat4* models, glm::mat3* normalMatrices, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        normalMatrices[i] = computeNormalMatrix(models[i]);
+    }
+}
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+// The inverse transpose of the upper 3x3 of a model matrix, which keeps normals perpendicular
+// to surfaces under non-uniform scale. For a rotation with uniform scale s it is just the
+// upper 3x3 divided by s^2, which is checked for first.
+glm::mat3 computeNormalMatrix(const glm::mat4& model);
+
+// the same for count matrices, with SSE when the target has it
+void computeNormalMatrices(const glm::mat4* models, glm::mat3* normalMatrices, size_t count);
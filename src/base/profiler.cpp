@@ -0,0 +1,179 @@
+#include <algorithm>
+
+#include "gl_resource_registry.h"
+#include "profiler.h"
+#include "tracer.h"
+
+constexpr int Profiler::kFrameLatency;
+constexpr int Profiler::kHistorySize;
+
+Profiler::~Profiler() {
+    if (!_allQueries.empty()) {
+        for (const GLuint query : _allQueries) {
+            GLResourceRegistry::onDelete(GLResourceType::Query, query);
+        }
+        glDeleteQueries(static_cast<GLsizei>(_allQueries.size()), _allQueries.data());
+    }
+}
+
+void Profiler::beginFrame() {
+    // taken before resolve() so that the profiler's own bookkeeping counts against the frame
+    const AllocationCounts frameStartAllocations = AllocationTracker::getThreadCounts();
+    const GLCallCounts frameStartGLCalls = GLCallStats::getCounts();
+
+    // the previous frame ends here, after its swap
+    FrameRecord& previous = _frames[_currentFrame];
+    if (previous.pending) {
+        previous.wallMs = getMsSinceFrameStart();
+    }
+
+    _currentFrame = (_currentFrame + 1) % kFrameLatency;
+
+    // this slot was recorded kFrameLatency frames ago, its queries have had time to finish
+    FrameRecord& frame = _frames[_currentFrame];
+    if (frame.pending) {
+        resolve(frame);
+    }
+
+    frame.samples.clear();
+    frame.queries.clear();
+    frame.index = _frameIndex++;
+    _openScopes.clear();
+    _openScopeAllocations.clear();
+    _openScopeGLCalls.clear();
+    _gpuScopeOpen = false;
+    _frameStart = Clock::now();
+    _frameStartAllocations = frameStartAllocations;
+    _frameStartGLCalls = frameStartGLCalls;
+}
+
+void Profiler::endFrame() {
+    while (!_openScopes.empty()) {
+        endScope();
+    }
+
+    FrameRecord& frame = _frames[_currentFrame];
+    frame.cpuMs = getMsSinceFrameStart();
+    const AllocationCounts allocations = AllocationTracker::getThreadCounts();
+    frame.allocations.allocations = allocations.allocations - _frameStartAllocations.allocations;
+    frame.allocations.bytes = allocations.bytes - _frameStartAllocations.bytes;
+    frame.glCalls = GLCallStats::getCounts() - _frameStartGLCalls;
+    frame.pending = true;
+}
+
+void Profiler::beginScope(const char* name, bool gpu) {
+    FrameRecord& frame = _frames[_currentFrame];
+
+    GLuint query = 0;
+    if (gpu && _gpuTimingEnabled && !_gpuScopeOpen) {
+        query = acquireQuery();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        _gpuScopeOpen = true;
+    }
+
+    const int depth = static_cast<int>(_openScopes.size());
+    _openScopes.push_back(frame.samples.size());
+    frame.samples.push_back({name, depth, getMsSinceFrameStart(), 0.0f, -1.0f, {}, {}});
+    frame.queries.push_back(query);
+    _openScopeAllocations.push_back(AllocationTracker::getThreadCounts());
+    _openScopeGLCalls.push_back(GLCallStats::getCounts());
+
+    // render passes show up in offline traces as well
+    if (Tracer::isEnabled()) {
+        Tracer::begin(name);
+    }
+}
+
+void Profiler::endScope() {
+    if (_openScopes.empty()) {
+        return;
+    }
+
+    FrameRecord& frame = _frames[_currentFrame];
+    const size_t index = _openScopes.back();
+    _openScopes.pop_back();
+
+    Sample& sample = frame.samples[index];
+    sample.cpuMs = getMsSinceFrameStart() - sample.cpuStartMs;
+
+    const AllocationCounts allocations = AllocationTracker::getThreadCounts();
+    sample.allocations.allocations = allocations.allocations - _openScopeAllocations.back().allocations;
+    sample.allocations.bytes = allocations.bytes - _openScopeAllocations.back().bytes;
+    _openScopeAllocations.pop_back();
+    sample.glCalls = GLCallStats::getCounts() - _openScopeGLCalls.back();
+    _openScopeGLCalls.pop_back();
+    if (frame.queries[index] != 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _gpuScopeOpen = false;
+    }
+
+    if (Tracer::isEnabled()) {
+        Tracer::end(sample.name);
+    }
+}
+
+GLuint Profiler::acquireQuery() {
+    if (_freeQueries.empty()) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        GLResourceRegistry::onCreate(GLResourceType::Query, query);
+        _allQueries.push_back(query);
+        return query;
+    }
+
+    const GLuint query = _freeQueries.back();
+    _freeQueries.pop_back();
+    return query;
+}
+
+void Profiler::resolve(FrameRecord& frame) {
+    // scopes that did not run this frame read zero, so every graph shares one time axis
+    for (auto& history : _histories) {
+        history.second.cpuMs[_historyOffset] = 0.0f;
+        history.second.gpuMs[_historyOffset] = 0.0f;
+    }
+
+    for (size_t i = 0; i < frame.samples.size(); ++i) {
+        Sample& sample = frame.samples[i];
+        const GLuint query = frame.queries[i];
+        if (query != 0) {
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                sample.gpuMs = static_cast<float>(elapsed) * 1.0e-6f;
+            }
+            _freeQueries.push_back(query);
+        }
+
+        // scopes that show up several times a frame are summed in the history
+        History& history = getHistory(sample.name);
+        history.cpuMs[_historyOffset] += sample.cpuMs;
+        history.gpuMs[_historyOffset] += std::max(sample.gpuMs, 0.0f);
+    }
+
+    getHistory("frame").cpuMs[_historyOffset] = frame.cpuMs;
+    _historyOffset = (_historyOffset + 1) % kHistorySize;
+
+    _lastFrame.swap(frame.samples);
+    _lastFrameCpuMs = frame.cpuMs;
+    _lastFrameWallMs = frame.wallMs;
+    _lastFrameAllocations = frame.allocations;
+    _lastFrameGLCalls = frame.glCalls;
+    _lastFrameIndex = frame.index;
+    frame.pending = false;
+}
+
+Profiler::History& Profiler::getHistory(const char* name) {
+    // looked up without building a std::string, only a scope's first frame allocates
+    auto iter = _histories.find(name);
+    if (iter == _histories.end()) {
+        iter = _histories.emplace(name, History()).first;
+    }
+    return iter->second;
+}
+
+float Profiler::getMsSinceFrameStart() const {
+    return std::chrono::duration<float, std::milli>(Clock::now() - _frameStart).count();
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "allocation_tracker.h"
+#include "gl_call_stats.h"
+#include "gl_utility.h"
+
+// Per-frame CPU scopes plus GL_TIME_ELAPSED queries around render passes.
+// Query results are read kFrameLatency frames later, when the GPU is long done with
+// them, so profiling never stalls the pipeline. Only used from the render thread.
+class Profiler {
+public:
+    static constexpr int kFrameLatency = 4;
+    static constexpr int kHistorySize = 240;
+
+    struct Sample {
+        const char* name;
+        int depth;
+        float cpuStartMs;
+        float cpuMs;
+        // negative when the scope had no query or the result was not ready in time
+        float gpuMs;
+        // heap allocations of this thread inside the scope, see AllocationTracker
+        AllocationCounts allocations;
+        // GL calls inside the scope, see GLCallStats
+        GLCallCounts glCalls;
+    };
+
+    // rolling per-scope times of the last kHistorySize frames, oldest at getHistoryOffset()
+    struct History {
+        std::vector<float> cpuMs = std::vector<float>(kHistorySize, 0.0f);
+        std::vector<float> gpuMs = std::vector<float>(kHistorySize, 0.0f);
+    };
+
+    Profiler() = default;
+
+    Profiler(const Profiler&) = delete;
+
+    ~Profiler();
+
+    void beginFrame();
+
+    void endFrame();
+
+    // GL_TIME_ELAPSED queries cannot nest, a gpu scope inside another one is timed on the cpu only
+    void beginScope(const char* name, bool gpu);
+
+    // off while the caller times whole frames with its own GL_TIME_ELAPSED query,
+    // every scope is then timed on the cpu only; changed between frames only
+    void setGpuTimingEnabled(bool enabled) {
+        _gpuTimingEnabled = enabled;
+    }
+
+    void endScope();
+
+    // the newest frame whose gpu times are known
+    const std::vector<Sample>& getLastFrame() const {
+        return _lastFrame;
+    }
+
+    float getLastFrameCpuMs() const {
+        return _lastFrameCpuMs;
+    }
+
+    // wall time from this frame's beginFrame() to the next one's, including swap and vsync
+    float getLastFrameWallMs() const {
+        return _lastFrameWallMs;
+    }
+
+    // heap allocations of the render thread between beginFrame() and endFrame()
+    const AllocationCounts& getLastFrameAllocations() const {
+        return _lastFrameAllocations;
+    }
+
+    // GL calls between beginFrame() and endFrame()
+    const GLCallCounts& getLastFrameGLCalls() const {
+        return _lastFrameGLCalls;
+    }
+
+    uint64_t getLastFrameIndex() const {
+        return _lastFrameIndex;
+    }
+
+    size_t getQueryCount() const {
+        return _allQueries.size();
+    }
+
+    using HistoryMap = std::map<std::string, History, std::less<>>;
+
+    const HistoryMap& getHistories() const {
+        return _histories;
+    }
+
+    int getHistoryOffset() const {
+        return _historyOffset;
+    }
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct FrameRecord {
+        std::vector<Sample> samples;
+        // parallel to samples, 0 when the scope was not timed on the gpu
+        std::vector<GLuint> queries;
+        uint64_t index = 0;
+        float cpuMs = 0.0f;
+        float wallMs = 0.0f;
+        AllocationCounts allocations;
+        GLCallCounts glCalls;
+        bool pending = false;
+    };
+
+    FrameRecord _frames[kFrameLatency];
+    int _currentFrame = 0;
+    uint64_t _frameIndex = 0;
+    Clock::time_point _frameStart;
+    std::vector<size_t> _openScopes;
+    std::vector<AllocationCounts> _openScopeAllocations;
+    AllocationCounts _frameStartAllocations;
+    std::vector<GLCallCounts> _openScopeGLCalls;
+    GLCallCounts _frameStartGLCalls;
+    bool _gpuScopeOpen = false;
+    bool _gpuTimingEnabled = true;
+    std::vector<GLuint> _freeQueries;
+    std::vector<GLuint> _allQueries;
+
+    std::vector<Sample> _lastFrame;
+    float _lastFrameCpuMs = 0.0f;
+    float _lastFrameWallMs = 0.0f;
+    uint64_t _lastFrameIndex = 0;
+    AllocationCounts _lastFrameAllocations;
+    GLCallCounts _lastFrameGLCalls;
+    HistoryMap _histories;
+    int _historyOffset = 0;
+
+    GLuint acquireQuery();
+
+    void resolve(FrameRecord& frame);
+
+    History& getHistory(const char* name);
+
+    float getMsSinceFrameStart() const;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, const char* name, bool gpu = true) : _profiler(profiler) {
+        _profiler.beginScope(name, gpu);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+
+    ~ProfileScope() {
+        _profiler.endScope();
+    }
+
+private:
+    Profiler& _profiler;
+};
@@ -0,0 +1,45 @@
+#include "render_pass.h"
+
+RenderPassState getRenderPassState(RenderPass pass) {
+    RenderPassState state;
+    switch (pass) {
+        case RenderPass::Opaque:
+            break;
+        case RenderPass::Skybox:
+            // the sky sits at depth 1.0, which the cleared depth buffer still passes with LEQUAL
+            state.depthWrite = false;
+            state.depthFunc = GL_LEQUAL;
+            break;
+        case RenderPass::Transparent:
+            state.depthWrite = false;
+            state.blend = true;
+            break;
+        case RenderPass::UI:
+            state.depthTest = false;
+            state.depthWrite = false;
+            state.blend = true;
+            break;
+    }
+    return state;
+}
+
+ScopedRenderPass::ScopedRenderPass(GLStateCache& state, RenderPass pass) : _state(state) {
+    _state.invalidate();
+    apply(_state, getRenderPassState(pass));
+}
+
+ScopedRenderPass::~ScopedRenderPass() {
+    _state.invalidate();
+    apply(_state, RenderPassState());
+}
+
+void ScopedRenderPass::apply(GLStateCache& state, const RenderPassState& passState) {
+    state.setEnabled(GL_DEPTH_TEST, passState.depthTest);
+    state.setDepthMask(passState.depthWrite);
+    state.setDepthFunc(passState.depthFunc);
+    state.setEnabled(GL_BLEND, passState.blend);
+    if (passState.blend) {
+        state.setBlendFunc(passState.blendSource, passState.blendDestination);
+    }
+    state.setEnabled(GL_CULL_FACE, passState.cullFace);
+}
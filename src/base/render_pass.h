@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "gl_state_cache.h"
+
+// in drawing order
+enum class RenderPass : uint8_t {
+    Opaque,
+    // behind everything opaque: drawn at the far plane, depth tested but not written
+    Skybox,
+    // blended, no depth writes
+    Transparent,
+    // screen space text and panels on top of the scene
+    UI
+};
+
+// the fixed function state a pass draws with; the defaults are the cheap opaque state
+// that holds outside of every pass
+struct RenderPassState {
+    bool depthTest = true;
+    bool depthWrite = true;
+    GLenum depthFunc = GL_LESS;
+    bool blend = false;
+    GLenum blendSource = GL_SRC_ALPHA;
+    GLenum blendDestination = GL_ONE_MINUS_SRC_ALPHA;
+    // off for every pass: the imported meshes make no promise about their winding
+    bool cullFace = false;
+};
+
+RenderPassState getRenderPassState(RenderPass pass);
+
+// Sets the pass's state for its lifetime and puts the default state back afterwards, so that
+// no blending or locked depth buffer leaks into the clear or the next pass. Both ends start
+// from an invalidated cache: draws inside may change state behind its back (e.g. imgui).
+class ScopedRenderPass {
+public:
+    ScopedRenderPass(GLStateCache& state, RenderPass pass);
+
+    ScopedRenderPass(const ScopedRenderPass&) = delete;
+
+    ScopedRenderPass& operator=(const ScopedRenderPass&) = delete;
+
+    ~ScopedRenderPass();
+
+    static void apply(GLStateCache& state, const RenderPassState& passState);
+
+private:
+    GLStateCache& _state;
+};
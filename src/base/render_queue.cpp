@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cstring>
+
+#include "render_queue.h"
+
+namespace {
+constexpr uint64_t kPassShift = 60;
+
+uint64_t maskBits(uint64_t value, int bits) {
+    return value & ((uint64_t(1) << bits) - 1);
+}
+
+// the bit pattern of a non-negative float grows with its value, its top 24 bits keep
+// the order at a precision that gets finer near the camera
+uint64_t quantizeDepth(float viewDepth) {
+    if (!(viewDepth > 0.0f)) {
+        return 0;
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &viewDepth, sizeof(bits));
+    return bits >> 8;
+}
+}  // namespace
+
+void RenderQueue::push(RenderPass pass, const GLSLProgram& program, GLuint texture,
+                       const Model& model, float viewDepth, uint32_t userIndex) {
+    const uint64_t key =
+        makeSortKey(pass, program.getHandle(), texture, model.getVao(), viewDepth);
+    _items.push_back({key, &program, &model, texture, userIndex});
+}
+
+void RenderQueue::sort() {
+    std::sort(_items.begin(), _items.end(), [](const DrawItem& lhs, const DrawItem& rhs) {
+        return lhs.sortKey < rhs.sortKey;
+    });
+}
+
+// GL names are small integers, 12 bits of each tell programs, textures and vertex arrays
+// apart well enough; a collision only costs a state change, never a wrong draw
+uint64_t RenderQueue::makeSortKey(RenderPass pass, GLuint program, GLuint texture, GLuint vao,
+                                  float viewDepth) {
+    const uint64_t depth = quantizeDepth(viewDepth);
+    uint64_t key = static_cast<uint64_t>(pass) << kPassShift;
+    if (pass == RenderPass::Transparent) {
+        // far to near comes first, the state only breaks ties
+        key |= maskBits(~depth, 24) << 36;
+        key |= maskBits(program, 12) << 24;
+        key |= maskBits(texture, 12) << 12;
+        key |= maskBits(vao, 12);
+    } else {
+        key |= maskBits(program, 12) << 48;
+        key |= maskBits(texture, 12) << 36;
+        key |= maskBits(vao, 12) << 24;
+        key |= depth;
+    }
+
+    return key;
+}
+
+std::pair<RenderQueue::Iterator, RenderQueue::Iterator> RenderQueue::findPass(
+    RenderPass pass) const {
+    const uint64_t first = static_cast<uint64_t>(pass) << kPassShift;
+    const uint64_t last = (static_cast<uint64_t>(pass) + 1) << kPassShift;
+    auto keyLess = [](const DrawItem& item, uint64_t key) {
+        return item.sortKey < key;
+    };
+    return {std::lower_bound(_items.begin(), _items.end(), first, keyLess),
+            std::lower_bound(_items.begin(), _items.end(), last, keyLess)};
+}
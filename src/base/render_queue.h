@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gl_state_cache.h"
+#include "glsl_program.h"
+#include "model.h"
+#include "render_pass.h"
+
+struct DrawItem {
+    uint64_t sortKey;
+    const GLSLProgram* program;
+    const Model* model;
+    // bound to GL_TEXTURE_2D on unit 0, 0 for none
+    GLuint texture;
+    // handed back to submit()'s callback to set the per draw uniforms
+    uint32_t userIndex;
+};
+
+// Draws collected over a frame and sorted once by a 64 bit key, so that items sharing a
+// program, texture and vertex array are drawn together. Opaque items are ordered by state
+// first and then front to back, transparent ones back to front.
+class RenderQueue {
+public:
+    void clear() {
+        _items.clear();
+    }
+
+    // viewDepth is the distance in front of the camera; the program, model and texture must
+    // outlive the submit() calls of this frame
+    void push(RenderPass pass, const GLSLProgram& program, GLuint texture, const Model& model,
+              float viewDepth, uint32_t userIndex);
+
+    void sort();
+
+    size_t size() const {
+        return _items.size();
+    }
+
+    // draws the items of one pass in key order, binding through state, from inside a
+    // ScopedRenderPass of that pass; setUniforms(const GLSLProgram&, uint32_t userIndex)
+    // runs with the item's program in use
+    template <typename SetUniforms>
+    void submit(RenderPass pass, GLStateCache& state, SetUniforms&& setUniforms) const {
+        const auto range = findPass(pass);
+        for (auto iter = range.first; iter != range.second; ++iter) {
+            state.useProgram(iter->program->getHandle());
+            if (iter->texture != 0) {
+                state.bindTexture(0, GL_TEXTURE_2D, iter->texture);
+            }
+            state.bindVertexArray(iter->model->getVao());
+            setUniforms(*iter->program, iter->userIndex);
+            iter->model->drawBound();
+        }
+
+        // later buffer setup must not end up recorded in one of our vertex arrays
+        state.bindVertexArray(0);
+    }
+
+    static uint64_t makeSortKey(RenderPass pass, GLuint program, GLuint texture, GLuint vao,
+                                float viewDepth);
+
+private:
+    using Iterator = std::vector<DrawItem>::const_iterator;
+
+    std::vector<DrawItem> _items;
+
+    std::pair<Iterator, Iterator> findPass(RenderPass pass) const;
+};
@@ -1,20 +1,22 @@
 #pragma once
 
+#include "gl_resource_registry.h"
 #include "gl_utility.h"
 
 class Sampler {
 public:
     Sampler() {
         glGenSamplers(1, &_handle);
+        GLResourceRegistry::onCreate(GLResourceType::Sampler, _handle);
     }
 
-    Sampler(Sampler&& rhs) noexcept {
-        rhs._handle = _handle;
-        _handle = 0;
+    Sampler(Sampler&& rhs) noexcept : _handle(rhs._handle) {
+        rhs._handle = 0;
     }
 
     ~Sampler() {
         if (_handle != 0) {
+            GLResourceRegistry::onDelete(GLResourceType::Sampler, _handle);
             glDeleteSamplers(1, &_handle);
         }
     }
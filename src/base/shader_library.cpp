@@ -0,0 +1,118 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "shader_library.h"
+
+ShaderLibrary::ShaderLibrary(const std::string& directory) : _directory(directory) {
+    if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\') {
+        _directory += '/';
+    }
+}
+
+GLSLProgram& ShaderLibrary::getVariant(
+    const std::string& vertexFile, const std::string& fragmentFile, uint32_t features) {
+    const std::string key = vertexFile + '|' + fragmentFile + '|' + std::to_string(features);
+    auto iter = _variants.find(key);
+    if (iter != _variants.end()) {
+        return *iter->second;
+    }
+
+    // expanded sources feed the program binary key, so each variant is cached on its own
+    std::unique_ptr<GLSLProgram> program(new GLSLProgram);
+    program->attachVertexShader(preprocess(vertexFile, features));
+    program->attachFragmentShader(preprocess(fragmentFile, features));
+    try {
+        program->link();
+    } catch (const std::exception& e) {
+        throw std::runtime_error("shader variant " + key + " failed: " + e.what());
+    }
+
+    return *(_variants[key] = std::move(program));
+}
+
+std::string ShaderLibrary::preprocess(const std::string& file, uint32_t features) {
+    std::string source;
+    std::unordered_set<std::string> included;
+    expandIncludes(file, source, included);
+
+    // #version has to stay the first statement
+    const std::string defines = makeDefines(features);
+    const size_t version = source.find("#version");
+    if (version == std::string::npos) {
+        return defines + source;
+    }
+
+    const size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return source + '\n' + defines;
+    }
+    source.insert(lineEnd + 1, defines);
+    return source;
+}
+
+const std::string& ShaderLibrary::readFile(const std::string& file) {
+    auto iter = _files.find(file);
+    if (iter != _files.end()) {
+        return iter->second;
+    }
+
+    const std::string path = _directory + file;
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+        throw std::runtime_error("read " + path + " error");
+    }
+    std::stringstream ss;
+    ss << is.rdbuf();
+    return _files[file] = ss.str();
+}
+
+void ShaderLibrary::expandIncludes(const std::string& file, std::string& out,
+                                   std::unordered_set<std::string>& included) {
+    // every file goes in once, which also ends include cycles
+    if (!included.insert(file).second) {
+        return;
+    }
+
+    std::istringstream lines(readFile(file));
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        const size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+            out += line;
+            out += '\n';
+            continue;
+        }
+
+        const size_t open = line.find('"', start + 8);
+        const size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos) {
+            throw std::runtime_error(
+                file + ":" + std::to_string(lineNumber) + ": malformed #include");
+        }
+        expandIncludes(line.substr(open + 1, close - open - 1), out, included);
+    }
+}
+
+std::string ShaderLibrary::makeDefines(uint32_t features) {
+    static const struct {
+        ShaderFeature feature;
+        const char* name;
+    } kDefines[] = {
+        {ShaderFeatureLit, "LIT"},
+        {ShaderFeatureTextured, "TEXTURED"},
+        {ShaderFeatureInstanced, "INSTANCED"},
+        {ShaderFeatureMorph, "MORPH"},
+        {ShaderFeatureSkinned, "SKINNED"},
+    };
+
+    std::string defines;
+    for (const auto& define : kDefines) {
+        if (features & define.feature) {
+            defines += std::string("#define ") + define.name + '\n';
+        }
+    }
+    return defines;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "glsl_program.h"
+
+// optional parts of a shader, each one turns into a #define in front of the sources
+enum ShaderFeature : uint32_t {
+    ShaderFeatureLit = 1 << 0,
+    ShaderFeatureTextured = 1 << 1,
+    ShaderFeatureInstanced = 1 << 2,
+    ShaderFeatureMorph = 1 << 3,
+    ShaderFeatureSkinned = 1 << 4
+};
+
+// Shader files under one directory, compiled into a program per feature set the first time
+// that set is asked for. Sources may #include "file" relative to the directory, expanded once
+// per source whatever #ifdef it sits in; the defines go right after the #version line.
+class ShaderLibrary {
+public:
+    explicit ShaderLibrary(const std::string& directory);
+
+    // the program stays valid as long as the library
+    GLSLProgram& getVariant(const std::string& vertexFile, const std::string& fragmentFile,
+                            uint32_t features);
+
+    size_t getVariantCount() const {
+        return _variants.size();
+    }
+
+    // the expanded source, as it is handed to the compiler
+    std::string preprocess(const std::string& file, uint32_t features);
+
+private:
+    std::string _directory;
+
+    std::unordered_map<std::string, std::unique_ptr<GLSLProgram>> _variants;
+
+    // raw files by name, every file is read once
+    std::unordered_map<std::string, std::string> _files;
+
+    const std::string& readFile(const std::string& file);
+
+    void expandIncludes(const std::string& file, std::string& out,
+                        std::unordered_set<std::string>& included);
+
+    static std::string makeDefines(uint32_t features);
+};
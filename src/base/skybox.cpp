@@ -1,4 +1,5 @@
 #include "skybox.h"
+#include "gl_resource_registry.h"
 
 SkyBox::SkyBox(const std::vector<std::string>& textureFilenames) {
     GLfloat vertices[] = {-1.0f, 1.0f,  -1.0f, -1.0f, -1.0f, -1.0f, 1.0f,  -1.0f, -1.0f,
@@ -26,6 +27,9 @@ SkyBox::SkyBox(const std::vector<std::string>& textureFilenames) {
     glBindVertexArray(_vao);
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
+    GLResourceRegistry::onCreate(GLResourceType::VertexArray, _vao);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _vbo);
+    GLResourceRegistry::setBufferSize(_vbo, sizeof(vertices));
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
@@ -89,9 +93,6 @@ void SkyBox::draw(const glm::mat4& projection, const glm::mat4& view) {
     // TODO:: draw skybox
     // write your code here
     // -----------------------------------------------
-    glDepthFunc(GL_LEQUAL);
-    glDepthMask(GL_FALSE);
-
     _shader->use();
     _texture->bind(0);
 
@@ -105,18 +106,18 @@ void SkyBox::draw(const glm::mat4& projection, const glm::mat4& view) {
     glBindVertexArray(0);
 
     _texture->unbind();
-    glDepthMask(GL_TRUE);
-    glDepthFunc(GL_LESS);
     // -----------------------------------------------
 }
 
 void SkyBox::cleanup() {
     if (_vbo != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _vbo);
         glDeleteBuffers(1, &_vbo);
         _vbo = 0;
     }
 
     if (_vao != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, _vao);
         glDeleteVertexArrays(1, &_vao);
         _vao = 0;
     }
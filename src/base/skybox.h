@@ -18,6 +18,8 @@ public:
 
     ~SkyBox();
 
+    // after the opaque objects, with depth func GL_LEQUAL and depth writes off
+    // (see RenderPass::Skybox)
     void draw(const glm::mat4& projection, const glm::mat4& view);
 
 private:
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    SpscQueue() = default;
+
+    SpscQueue(const SpscQueue&) = delete;
+
+    // returns false if the queue is full
+    bool tryPush(const T& value) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        _items[tail & (Capacity - 1)] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false if the queue is empty
+    bool tryPop(T& value) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, Capacity> _items;
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
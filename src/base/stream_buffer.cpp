@@ -0,0 +1,147 @@
+#include <cstring>
+#include <iostream>
+
+#include "gl_resource_registry.h"
+#include "stream_buffer.h"
+
+namespace {
+uint64_t alignUp(uint64_t position, uint64_t alignment) {
+    return (position + alignment - 1) & ~(alignment - 1);
+}
+}  // namespace
+
+StreamBuffer::StreamBuffer(size_t capacity)
+    : _capacity(static_cast<size_t>(alignUp(capacity, kMaxAlignment))),
+      _useFences(GLAD_GL_VERSION_3_2 != 0) {
+    // mapped through GL_COPY_WRITE_BUFFER, so that neither the vertex array's element
+    // buffer nor any other binding that users care about changes
+    glGenBuffers(1, &_handle);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, _capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    GLResourceRegistry::onCreate(GLResourceType::Buffer, _handle);
+    GLResourceRegistry::setBufferSize(_handle, _capacity);
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (const FrameFence& frame : _frames) {
+        glDeleteSync(frame.fence);
+    }
+
+    if (_handle != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, _handle);
+        glDeleteBuffers(1, &_handle);
+    }
+}
+
+StreamRange StreamBuffer::map(size_t size, size_t alignment) {
+    if (size == 0 || size > _capacity) {
+        return StreamRange();
+    }
+
+    uint64_t start = alignUp(_head, alignment);
+    if (start % _capacity + size > _capacity) {
+        // a range never wraps, skip the rest of this lap
+        start = (start / _capacity + 1) * _capacity;
+    }
+
+    if (start + size > _retired + _capacity) {
+        if (!_useFences || start + size > _frameStart + _capacity) {
+            orphan();
+            start = (_head / _capacity + 1) * _capacity;
+            _retired = start;
+            _frameStart = start;
+        } else {
+            // every frame before this one is fenced, so this ends at the latest at _frameStart
+            while (start + size > _retired + _capacity) {
+                waitOldestFrame();
+            }
+        }
+    }
+
+    _head = start + size;
+
+    StreamRange range;
+    range.offset = static_cast<GLintptr>(start % _capacity);
+    range.size = static_cast<GLsizeiptr>(size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+    range.data = glMapBufferRange(GL_COPY_WRITE_BUFFER, range.offset, range.size,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (range.data == nullptr) {
+        std::cerr << "stream buffer map failure" << std::endl;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    return range;
+}
+
+void StreamBuffer::unmap() {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+    if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_FALSE) {
+        std::cerr << "stream buffer contents lost while mapped" << std::endl;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GLintptr StreamBuffer::upload(const void* data, size_t size, size_t alignment) {
+    const StreamRange range = map(size, alignment);
+    if (range.data == nullptr) {
+        return -1;
+    }
+
+    std::memcpy(range.data, data, size);
+    unmap();
+    return range.offset;
+}
+
+void StreamBuffer::endFrame() {
+    if (!_useFences || _head == _frameStart) {
+        return;
+    }
+
+    _frames.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), _head});
+    _frameStart = _head;
+
+    // frames the gpu already finished free their part without any waiting later
+    while (!_frames.empty()) {
+        const GLenum status = glClientWaitSync(_frames.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        _retired = _frames.front().end;
+        glDeleteSync(_frames.front().fence);
+        _frames.pop_front();
+    }
+}
+
+void StreamBuffer::orphan() {
+    ++_orphans;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+    glBufferData(GL_COPY_WRITE_BUFFER, _capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // the new storage is not used by any frame
+    for (const FrameFence& frame : _frames) {
+        glDeleteSync(frame.fence);
+    }
+    _frames.clear();
+}
+
+void StreamBuffer::waitOldestFrame() {
+    const FrameFence frame = _frames.front();
+    _frames.pop_front();
+
+    GLenum status = glClientWaitSync(frame.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        ++_stalls;
+        const GLuint64 timeoutNs = 1000000000;
+        do {
+            status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_WAIT_FAILED) {
+            std::cerr << "stream buffer fence wait failure" << std::endl;
+        }
+    }
+
+    glDeleteSync(frame.fence);
+    _retired = frame.end;
+}
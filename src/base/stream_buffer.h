@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include "gl_utility.h"
+
+// A region of a StreamBuffer, mapped for writing until StreamBuffer::unmap()
+struct StreamRange {
+    void* data = nullptr;
+    // byte offset into StreamBuffer::getHandle()
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;
+};
+
+// One buffer shared by everything that streams vertex, index or uniform data each frame.
+// Allocations are carved out of it as a ring and mapped without synchronization; a fence at
+// the end of every frame tells when the gpu is done with that frame's part, and only an
+// allocation that runs into a part still in flight waits for it.
+//
+// Without fence sync, and for a frame that needs more than the whole buffer, the storage
+// is orphaned instead. Orphaning loses nothing already drawn from, but data allocated and
+// not yet drawn from goes with it, so draw from a range before making the next allocation.
+class StreamBuffer {
+public:
+    explicit StreamBuffer(size_t capacity);
+
+    StreamBuffer(const StreamBuffer&) = delete;
+
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    ~StreamBuffer();
+
+    GLuint getHandle() const {
+        return _handle;
+    }
+
+    size_t getCapacity() const {
+        return _capacity;
+    }
+
+    // alignment must be a power of two up to kMaxAlignment, e.g. the vertex size or
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT; data is null when size exceeds the capacity
+    StreamRange map(size_t size, size_t alignment);
+
+    void unmap();
+
+    // map(), copy and unmap(), returns the offset of the data or -1
+    GLintptr upload(const void* data, size_t size, size_t alignment);
+
+    // after the last draw of the frame that reads from the buffer
+    void endFrame();
+
+    // allocations that had to wait for the gpu, and orphaned storages
+    uint32_t getStallCount() const {
+        return _stalls;
+    }
+
+    uint32_t getOrphanCount() const {
+        return _orphans;
+    }
+
+    static constexpr size_t kMaxAlignment = 256;
+
+private:
+    struct FrameFence {
+        GLsync fence;
+        // ring position everything before which the frame used
+        uint64_t end;
+    };
+
+    GLuint _handle = 0;
+    size_t _capacity = 0;
+    bool _useFences = false;
+
+    // positions count bytes ever allocated, the offset in the buffer is position % capacity
+    uint64_t _head = 0;
+    // the gpu is done with everything before this position
+    uint64_t _retired = 0;
+    // where the current frame started
+    uint64_t _frameStart = 0;
+    std::deque<FrameFence> _frames;
+
+    uint32_t _stalls = 0;
+    uint32_t _orphans = 0;
+
+    void orphan();
+
+    void waitOldestFrame();
+};
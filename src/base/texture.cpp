@@ -5,6 +5,7 @@
 Texture::Texture() {
     // create texture object
     glGenTextures(1, &_handle);
+    GLResourceRegistry::onCreate(GLResourceType::Texture, _handle);
 }
 
 Texture::Texture(Texture&& rhs) noexcept : _handle(rhs._handle) {
@@ -14,6 +15,7 @@ Texture::Texture(Texture&& rhs) noexcept : _handle(rhs._handle) {
 Texture::~Texture() {
     // destroy texture object
     if (_handle != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Texture, _handle);
         glDeleteTextures(1, &_handle);
         _handle = 0;
     }
@@ -35,6 +37,7 @@ void Texture::check() {
 
 void Texture::cleanup() {
     if (_handle != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::Texture, _handle);
         glDeleteTextures(1, &_handle);
         _handle = 0;
     }
@@ -7,6 +7,7 @@
 #include <stb_image.h>
 #include <stb_image_write.h>
 
+#include "gl_resource_registry.h"
 #include "gl_utility.h"
 
 class Texture {
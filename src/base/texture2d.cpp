@@ -9,6 +9,7 @@ Texture2D::Texture2D(
     glBindTexture(GL_TEXTURE_2D, _handle);
     setDefaultParameters();
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, dataType, data);
+    GLResourceRegistry::setTextureSize(_handle, internalFormat, width, height);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -25,6 +26,7 @@ void Texture2D::unbind() const {
 
 void Texture2D::generateMipmap() const {
     glGenerateMipmap(GL_TEXTURE_2D);
+    GLResourceRegistry::setTextureMipmapped(_handle);
 }
 
 void Texture2D::setParamterInt(GLenum name, int value) const {
@@ -42,25 +44,17 @@ void Texture2D::setDefaultParameters() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 }
 
-ImageTexture2D::ImageTexture2D(const std::string& path) : _uri(path) {
-    // load image to the memory
-    stbi_set_flip_vertically_on_load(true);
-    int width = 0, height = 0, channels = 0;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
-    if (data == nullptr) {
-        cleanup();
-        throw std::runtime_error("load " + path + " failure");
-    }
+ImageTexture2D::ImageTexture2D(const std::string& path) : ImageTexture2D(decode(path), path) {}
 
+ImageTexture2D::ImageTexture2D(const DecodedImage& image, const std::string& uri) : _uri(uri) {
     // choose image format
     GLenum format = GL_RGB;
-    switch (channels) {
+    switch (image.channels) {
     case 1: format = GL_RED; break;
     case 3: format = GL_RGB; break;
     case 4: format = GL_RGBA; break;
     default:
         cleanup();
-        stbi_image_free(data);
         throw std::runtime_error("unsupported format");
     }
     GLint internalFormat = static_cast<GLint>(format);
@@ -71,13 +65,12 @@ ImageTexture2D::ImageTexture2D(const std::string& path) : _uri(path) {
     setDefaultParameters();
 
     // transfer the image data to GPU
-    upload(data, width, height, channels, internalFormat, format, GL_UNSIGNED_BYTE);
+    upload(
+        image.pixels.get(), image.width, image.height, image.channels, internalFormat, format,
+        GL_UNSIGNED_BYTE);
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    // free data
-    stbi_image_free(data);
-
     // check error
     check();
 }
@@ -109,6 +102,20 @@ const std::string& ImageTexture2D::getUri() const {
     return _uri;
 }
 
+DecodedImage ImageTexture2D::decode(const std::string& path) {
+    // the flip flag is per thread so that concurrent decodes do not race on it
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    DecodedImage image;
+    unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (data == nullptr) {
+        throw std::runtime_error("load " + path + " failure");
+    }
+
+    image.pixels.reset(data, stbi_image_free);
+    return image;
+}
+
 void ImageTexture2D::setDefaultParameters() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -135,6 +142,7 @@ void ImageTexture2D::upload(
 
     // 2. transfer data
     glTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0, format, type, data);
+    GLResourceRegistry::setTextureSize(_handle, internalformat, width, height);
 
     // 3. restore alignment
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
@@ -146,6 +154,7 @@ Texture2DArray::Texture2DArray(
     glTexImage3D(
         GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layers, 0, format, dataType,
         nullptr);
+    GLResourceRegistry::setTextureSize(_handle, internalFormat, width, height, layers);
     setDefaultParameters();
     glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
@@ -163,6 +172,7 @@ void Texture2DArray::unbind() const {
 
 void Texture2DArray::generateMipmap() const {
     glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    GLResourceRegistry::setTextureMipmapped(_handle);
 }
 
 void Texture2DArray::setParamterInt(GLenum name, int value) const {
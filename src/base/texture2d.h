@@ -1,9 +1,18 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "texture.h"
 
+// pixels of an image file decoded on the cpu, can be produced on any thread
+struct DecodedImage {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::shared_ptr<unsigned char> pixels;
+};
+
 class Texture2D : public Texture {
 public:
     Texture2D() = default;
@@ -34,6 +43,8 @@ class ImageTexture2D : public Texture2D {
 public:
     ImageTexture2D(const std::string& path);
 
+    ImageTexture2D(const DecodedImage& image, const std::string& uri);
+
     ImageTexture2D(
         const void* data, int width, int height, int channels, GLint internalformat, GLenum format,
         GLenum type, const std::string& uri);
@@ -44,6 +55,9 @@ public:
 
     const std::string& getUri() const;
 
+    // decodes the image without touching GL, safe to call on a worker thread
+    static DecodedImage decode(const std::string& path);
+
 private:
     std::string _uri;
 
@@ -17,6 +17,7 @@ TextureCubemap::TextureCubemap(
             GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, width, height, 0, format,
             dataType, nullptr);
     }
+    GLResourceRegistry::setTextureSize(_handle, internalFormat, width, height, 6);
 
     glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
@@ -34,6 +35,7 @@ void TextureCubemap::unbind() const {
 
 void TextureCubemap::generateMipmap() const {
     glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    GLResourceRegistry::setTextureMipmapped(_handle);
 }
 
 void TextureCubemap::setParamterInt(GLenum name, int value) const {
@@ -48,6 +50,9 @@ ImageTextureCubemap::ImageTextureCubemap(const std::vector<std::string>& filepat
     // write your code here
     // -----------------------------------------------
     int width, height, nrChannels;
+
+    // the faces relied on the global flip flag ImageTexture2D used to leave set
+    stbi_set_flip_vertically_on_load_thread(true);
     
     glBindTexture(GL_TEXTURE_CUBE_MAP, _handle);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -60,6 +65,7 @@ ImageTextureCubemap::ImageTextureCubemap(const std::vector<std::string>& filepat
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
         stbi_image_free(data);
     }
+    GLResourceRegistry::setTextureSize(_handle, GL_RGB, width, height, 6);
     glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
     // -----------------------------------------------
 }
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "tracer.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+    const char* name;
+    int64_t timestamp;
+    double value;
+    char phase;
+};
+
+// Written by one thread only. The owner publishes each event by bumping count with release
+// semantics, so a reader that loads count with acquire sees complete events.
+struct TraceBuffer {
+    static constexpr size_t kCapacity = 1 << 18;
+
+    std::vector<TraceEvent> events = std::vector<TraceEvent>(kCapacity);
+    std::atomic<size_t> count{0};
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+// One per thread that was named or recorded something. The event buffer is only attached
+// on the first event while tracing, so that naming a thread costs no more than the name.
+struct ThreadRecord {
+    uint32_t threadId = 0;
+    std::string threadName;
+    // written by the owner under registryMutex, read by it without
+    TraceBuffer* buffer = nullptr;
+    bool exited = false;
+};
+
+const Clock::time_point origin = Clock::now();
+std::atomic<uint32_t> currentEpoch{0};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadRecord>> threads;
+// every buffer ever allocated, attached to a record or waiting in freeBuffers
+std::vector<std::unique_ptr<TraceBuffer>> buffers;
+std::vector<TraceBuffer*> freeBuffers;
+uint32_t nextThreadId = 1;
+std::unordered_set<std::string> internedNames;
+
+bool hasCurrentEvents(const TraceBuffer& buffer) {
+    return buffer.epoch.load(std::memory_order_relaxed)
+               == currentEpoch.load(std::memory_order_relaxed)
+           && buffer.count.load(std::memory_order_relaxed) > 0;
+}
+
+// registryMutex held; the record goes away with the thread unless the current trace
+// still needs the events in its buffer, then start() drops it later
+void releaseThread(ThreadRecord* record) {
+    record->exited = true;
+    if (record->buffer != nullptr && hasCurrentEvents(*record->buffer)) {
+        return;
+    }
+
+    if (record->buffer != nullptr) {
+        freeBuffers.push_back(record->buffer);
+    }
+    threads.erase(std::find_if(threads.begin(), threads.end(),
+        [record](const std::unique_ptr<ThreadRecord>& thread) { return thread.get() == record; }));
+}
+
+// hands the thread's record back to the registry when the thread exits
+struct ThreadSlot {
+    ThreadRecord* record = nullptr;
+
+    ~ThreadSlot() {
+        if (record != nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            releaseThread(record);
+        }
+    }
+};
+
+thread_local ThreadSlot tlsThread;
+
+// registryMutex held
+ThreadRecord& getThreadRecordLocked() {
+    if (tlsThread.record == nullptr) {
+        threads.emplace_back(new ThreadRecord);
+        tlsThread.record = threads.back().get();
+        tlsThread.record->threadId = nextThreadId++;
+    }
+    return *tlsThread.record;
+}
+
+TraceBuffer* getThreadBuffer() {
+    ThreadRecord* record = tlsThread.record;
+    if (record != nullptr && record->buffer != nullptr) {
+        return record->buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    record = &getThreadRecordLocked();
+    if (!freeBuffers.empty()) {
+        record->buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        // reused buffers may still hold events of this epoch from their last thread
+        record->buffer->epoch.store(0, std::memory_order_relaxed);
+    } else {
+        buffers.emplace_back(new TraceBuffer);
+        record->buffer = buffers.back().get();
+    }
+    return record->buffer;
+}
+
+void record(const char* name, char phase, double value) {
+    // a scope that outlives stop() must not allocate a buffer for its end event
+    ThreadRecord* thread = tlsThread.record;
+    if ((thread == nullptr || thread->buffer == nullptr) && !Tracer::isEnabled()) {
+        return;
+    }
+    TraceBuffer& buffer = *getThreadBuffer();
+
+    // the first event after start() throws away what this thread recorded before
+    const uint32_t epoch = currentEpoch.load(std::memory_order_relaxed);
+    if (buffer.epoch.load(std::memory_order_relaxed) != epoch) {
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.epoch.store(epoch, std::memory_order_release);
+    }
+
+    const size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index == TraceBuffer::kCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const int64_t timestamp =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+    buffer.events[index] = {name, timestamp, value, phase};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void writeEscaped(std::ofstream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        switch (*c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        default: out << *c; break;
+        }
+    }
+    out << '"';
+}
+} // namespace
+
+std::atomic<bool> Tracer::_enabled{false};
+
+void Tracer::start() {
+    {
+        // threads that exited during the last trace are not part of the new one
+        std::lock_guard<std::mutex> lock(registryMutex);
+        currentEpoch.fetch_add(1, std::memory_order_relaxed);
+        for (auto iter = threads.begin(); iter != threads.end();) {
+            if ((*iter)->exited) {
+                if ((*iter)->buffer != nullptr) {
+                    freeBuffers.push_back((*iter)->buffer);
+                }
+                iter = threads.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    _enabled.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::begin(const char* name) {
+    record(name, 'B', 0.0);
+}
+
+void Tracer::end(const char* name) {
+    record(name, 'E', 0.0);
+}
+
+void Tracer::counter(const char* name, double value) {
+    record(name, 'C', value);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    getThreadRecordLocked().threadName = name;
+}
+
+const char* Tracer::intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return internedNames.insert(name).first->c_str();
+}
+
+void Tracer::writeChromeJson(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("open " + path + " for writing failure");
+    }
+
+    const uint32_t epoch = currentEpoch.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (const auto& thread : threads) {
+        if (!thread->threadName.empty()) {
+            out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                << thread->threadId << ", \"args\": {\"name\": ";
+            writeEscaped(out, thread->threadName.c_str());
+            out << "}}";
+            first = false;
+        }
+
+        const TraceBuffer* buffer = thread->buffer;
+        if (buffer == nullptr || buffer->epoch.load(std::memory_order_acquire) != epoch) {
+            continue;
+        }
+
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            out << (first ? "" : ",\n") << "{\"name\": ";
+            writeEscaped(out, event.name);
+            // chrome wants microseconds
+            out << ", \"ph\": \"" << event.phase << "\", \"ts\": " << event.timestamp / 1000.0
+                << ", \"pid\": 1, \"tid\": " << thread->threadId;
+            if (event.phase == 'C') {
+                out << ", \"args\": {\"value\": " << event.value << "}";
+            }
+            out << "}";
+            first = false;
+        }
+
+        const uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped > 0) {
+            std::cerr << "trace buffer of thread " << thread->threadId << " was full, " << dropped
+                      << " events dropped" << std::endl;
+        }
+    }
+    out << "\n]}\n";
+
+    if (!out) {
+        throw std::runtime_error("write " + path + " failure");
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Trace events for offline analysis, written as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). Every thread appends to its own buffer without locks, allocated on its
+// first event while tracing and reused once the thread has exited; when tracing is off a
+// scope costs one relaxed atomic load.
+// Event names are not copied, they must be string literals or come from intern().
+class Tracer {
+public:
+    // starts a new trace, events of an earlier one are dropped
+    static void start();
+
+    static void stop();
+
+    static bool isEnabled() {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    static void begin(const char* name);
+
+    static void end(const char* name);
+
+    static void counter(const char* name, double value);
+
+    // shown instead of the thread id in the trace viewer
+    static void setThreadName(const std::string& name);
+
+    // a copy of name that lives until the process exits, for names built at runtime
+    static const char* intern(const std::string& name);
+
+    // may be called while tracing, events recorded after the call are not included
+    static void writeChromeJson(const std::string& path);
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : _name(Tracer::isEnabled() ? name : nullptr) {
+        if (_name != nullptr) {
+            Tracer::begin(_name);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+
+    ~TraceScope() {
+        if (_name != nullptr) {
+            Tracer::end(_name);
+        }
+    }
+
+private:
+    const char* _name;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value)            \
+    do {                                      \
+        if (Tracer::isEnabled()) {            \
+            Tracer::counter((name), (value)); \
+        }                                     \
+    } while (0)
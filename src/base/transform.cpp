@@ -26,7 +26,25 @@ glm::vec3 Transform::getRight() const {
     return rotation * getDefaultRight();
 }
 
-glm::mat4 Transform::getLocalMatrix() const {
-    return glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation)
-           * glm::scale(glm::mat4(1.0f), scale);
+const glm::mat4& Transform::getLocalMatrix() const {
+    update();
+    return _localMatrix;
+}
+
+uint32_t Transform::getVersion() const {
+    update();
+    return _version;
+}
+
+void Transform::update() const {
+    if (position == _cachedPosition && rotation == _cachedRotation && scale == _cachedScale) {
+        return;
+    }
+
+    _cachedPosition = position;
+    _cachedRotation = rotation;
+    _cachedScale = scale;
+    _localMatrix = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation)
+                   * glm::scale(glm::mat4(1.0f), scale);
+    ++_version;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include <glm/ext.hpp>
@@ -22,7 +23,12 @@ public:
 
     glm::vec3 getRight() const;
 
-    glm::mat4 getLocalMatrix() const;
+    // recomputed only when position, rotation or scale changed since the last call
+    const glm::mat4& getLocalMatrix() const;
+
+    // changes whenever position, rotation or scale do; keep the value from the last time
+    // something was derived from the transform and compare to skip redoing it
+    uint32_t getVersion() const;
 
     static constexpr glm::vec3 getDefaultFront() {
         return {0.0f, 0.0f, -1.0f};
@@ -35,4 +41,15 @@ public:
     static constexpr glm::vec3 getDefaultRight() {
         return {1.0f, 0.0f, 0.0f};
     }
+
+private:
+    // the fields are public, so changes are found by comparing them to the ones the
+    // cache was built from rather than by setters raising a flag
+    mutable glm::vec3 _cachedPosition = {0.0f, 0.0f, 0.0f};
+    mutable glm::quat _cachedRotation = {1.0f, 0.0f, 0.0f, 0.0f};
+    mutable glm::vec3 _cachedScale = {1.0f, 1.0f, 1.0f};
+    mutable glm::mat4 _localMatrix = glm::mat4(1.0f);
+    mutable uint32_t _version = 1;
+
+    void update() const;
 };
\ No newline at end of file
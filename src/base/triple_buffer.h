@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one producer thread and one consumer thread.
+// The producer fills getWriteBuffer() and publish()es it; the consumer calls update()
+// to grab the most recently published buffer and reads it through getReadBuffer().
+// Neither side ever waits: the producer may overwrite a published buffer the consumer
+// has not picked up yet, so the consumer always sees the latest complete state.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+
+    T& getWriteBuffer() {
+        return _buffers[_writeIndex];
+    }
+
+    void publish() {
+        const uint8_t previous =
+            _middle.exchange(static_cast<uint8_t>(_writeIndex | kFreshBit), std::memory_order_acq_rel);
+        _writeIndex = previous & kIndexMask;
+    }
+
+    // returns true if a newer buffer became readable
+    bool update() {
+        if ((_middle.load(std::memory_order_relaxed) & kFreshBit) == 0) {
+            return false;
+        }
+
+        const uint8_t previous = _middle.exchange(_readIndex, std::memory_order_acq_rel);
+        _readIndex = previous & kIndexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const {
+        return _buffers[_readIndex];
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFreshBit = 0x4;
+
+    T _buffers[3];
+    uint8_t _writeIndex = 0;
+    uint8_t _readIndex = 1;
+    std::atomic<uint8_t> _middle{2};
+};
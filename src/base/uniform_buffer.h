@@ -1,26 +1,42 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <glm/glm.hpp>
+
+#include "gl_resource_registry.h"
 #include "gl_utility.h"
+#include "glsl_program.h"
 
+// A uniform block with a cpu staging copy: update() only writes the copy and widens the
+// dirty range, upload() sends that range with a single glBufferSubData.
 class UniformBuffer {
 public:
-    UniformBuffer(size_t bufferSize, GLenum usage) {
+    UniformBuffer(size_t bufferSize, GLenum usage)
+        : _staging(bufferSize, 0), _dirtyBegin(0), _dirtyEnd(bufferSize) {
         glGenBuffers(1, &_handle);
         glBindBuffer(GL_UNIFORM_BUFFER, _handle);
         glBufferData(GL_UNIFORM_BUFFER, bufferSize, nullptr, usage);
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, _handle);
+        GLResourceRegistry::setBufferSize(_handle, bufferSize);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
     UniformBuffer(UniformBuffer&& rhs) noexcept
-        : _handle(rhs._handle), _offsetMap(std::move(rhs._offsetMap)) {
+        : _handle(rhs._handle), _offsetMap(std::move(rhs._offsetMap)),
+          _staging(std::move(rhs._staging)), _dirtyBegin(rhs._dirtyBegin),
+          _dirtyEnd(rhs._dirtyEnd) {
         rhs._handle = 0;
     }
 
     ~UniformBuffer() {
         if (_handle != 0) {
+            GLResourceRegistry::onDelete(GLResourceType::Buffer, _handle);
             glDeleteBuffers(1, &_handle);
             _handle = 0;
         }
@@ -34,34 +50,75 @@ public:
         _offsetMap[name] = offset;
     }
 
+    // the offsets the program's layout gave the block variables, std140 blocks are laid
+    // out the same in every program
+    void reflectOffsets(const GLSLProgram& program, const std::vector<std::string>& names) {
+        for (const auto& name : names) {
+            const int offset = program.getUniformBlockVariableOffset(name);
+            if (offset < 0) {
+                throw std::runtime_error("cannot find " + name + " in the uniform block");
+            }
+            setOffset(name, static_cast<size_t>(offset));
+        }
+    }
+
     template <typename T>
-    void update(const std::string& name, const T& value) const {
+    void update(const std::string& name, const T& value) {
         const auto iter = _offsetMap.find(name);
         if (iter == _offsetMap.end()) {
             std::cerr << "cannot find " + name + " in the ubo" << std::endl;
             return;
         }
 
+        write(iter->second, &value, sizeof(T));
+    }
+
+    // sends everything updated since the last upload, nothing if no value changed
+    void upload() {
+        if (_dirtyBegin >= _dirtyEnd) {
+            return;
+        }
+
         glBindBuffer(GL_UNIFORM_BUFFER, _handle);
-        glBufferSubData(GL_UNIFORM_BUFFER, iter->second, sizeof(T), &value);
+        glBufferSubData(
+            GL_UNIFORM_BUFFER, _dirtyBegin, _dirtyEnd - _dirtyBegin, _staging.data() + _dirtyBegin);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        _dirtyBegin = _staging.size();
+        _dirtyEnd = 0;
     }
 
 private:
     GLuint _handle{};
-    std::map<std::string, size_t> _offsetMap;
+    std::unordered_map<std::string, size_t> _offsetMap;
+    std::vector<unsigned char> _staging;
+    size_t _dirtyBegin;
+    size_t _dirtyEnd;
+
+    void write(size_t offset, const void* data, size_t size) {
+        if (offset + size > _staging.size()) {
+            std::cerr << "ubo write out of range" << std::endl;
+            return;
+        }
+
+        if (std::memcmp(_staging.data() + offset, data, size) == 0) {
+            return;
+        }
+
+        std::memcpy(_staging.data() + offset, data, size);
+        _dirtyBegin = std::min(_dirtyBegin, offset);
+        _dirtyEnd = std::max(_dirtyEnd, offset + size);
+    }
 };
 
+// std140 stores a bool in 4 bytes
 template <>
-inline void UniformBuffer::update<bool>(const std::string& name, const bool& value) const {
-    const auto iter = _offsetMap.find(name);
-    if (iter == _offsetMap.end()) {
-        std::cerr << "cannot find " + name + " in the ubo" << std::endl;
-        return;
-    }
+inline void UniformBuffer::update<bool>(const std::string& name, const bool& value) {
+    update(name, static_cast<int>(value));
+}
 
-    int intVal = static_cast<int>(value);
-    glBindBuffer(GL_UNIFORM_BUFFER, _handle);
-    glBufferSubData(GL_UNIFORM_BUFFER, iter->second, sizeof(int), &intVal);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-}
\ No newline at end of file
+// std140 pads every mat3 column to a vec4
+template <>
+inline void UniformBuffer::update<glm::mat3>(const std::string& name, const glm::mat3& value) {
+    update(name, glm::mat3x4(value));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// Fraction of wall-clock time a thread spends working, averaged over a short window.
+// addBusyTime() is called from the measured thread; getUtilization() from any thread.
+class UtilizationMeter {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    UtilizationMeter(float window = 0.5f) : _window(window) {}
+
+    void addBusyTime(Clock::duration busyTime) {
+        _busyTime += busyTime;
+
+        const auto now = Clock::now();
+        const float elapsed = std::chrono::duration<float>(now - _windowStart).count();
+        if (elapsed >= _window) {
+            const float busy = std::chrono::duration<float>(_busyTime).count();
+            _utilization.store(busy / elapsed, std::memory_order_relaxed);
+            _busyTime = Clock::duration::zero();
+            _windowStart = now;
+        }
+    }
+
+    float getUtilization() const {
+        return _utilization.load(std::memory_order_relaxed);
+    }
+
+private:
+    const float _window;
+    Clock::time_point _windowStart = Clock::now();
+    Clock::duration _busyTime = Clock::duration::zero();
+    std::atomic<float> _utilization{0.0f};
+};
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include "bench_harness.h"
+
+BenchmarkHarness::BenchmarkHarness(int warmupRuns, int repetitions, const std::string& filter)
+    : _warmupRuns(warmupRuns), _repetitions(std::max(1, repetitions)), _filter(filter) {
+    std::printf("%-40s %12s %12s %12s %14s\n", "benchmark", "median (us)", "stddev (us)",
+                "p90 (us)", "items/s");
+}
+
+bool BenchmarkHarness::isEnabled(const std::string& name) const {
+    return name.find(_filter) != std::string::npos;
+}
+
+void BenchmarkHarness::run(
+    const std::string& name, const std::function<void()>& function, size_t itemsPerRun) {
+    if (!isEnabled(name)) {
+        return;
+    }
+
+    for (int i = 0; i < _warmupRuns; ++i) {
+        function();
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.itemsPerRun = itemsPerRun;
+    result.samples.reserve(_repetitions);
+    for (int i = 0; i < _repetitions; ++i) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        function();
+        const auto end = std::chrono::high_resolution_clock::now();
+        result.samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    result.stats = computeStats(result.samples);
+
+    const double itemsPerSecond = result.stats.median > 0.0
+                                      ? itemsPerRun * 1.0e6 / result.stats.median
+                                      : 0.0;
+    std::printf("%-40s %12.3f %12.3f %12.3f %14.4g\n", name.c_str(), result.stats.median,
+                result.stats.stddev, result.stats.p90, itemsPerSecond);
+
+    _results.push_back(std::move(result));
+}
+
+void BenchmarkHarness::writeJson(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("open " + path + " for writing failure");
+    }
+
+    out << "{\n";
+#ifdef NDEBUG
+    out << "  \"build\": \"release\",\n";
+#else
+    out << "  \"build\": \"debug\",\n";
+#endif
+    out << "  \"warmup_runs\": " << _warmupRuns << ",\n";
+    out << "  \"repetitions\": " << _repetitions << ",\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < _results.size(); ++i) {
+        const BenchmarkResult& result = _results[i];
+        const BenchmarkStats& stats = result.stats;
+        out << "    {\"name\": \"" << result.name << "\", \"items_per_run\": " << result.itemsPerRun
+            << ", \"us\": {\"min\": " << stats.min << ", \"median\": " << stats.median
+            << ", \"mean\": " << stats.mean << ", \"stddev\": " << stats.stddev
+            << ", \"p90\": " << stats.p90 << ", \"max\": " << stats.max << "}}"
+            << (i + 1 < _results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    if (!out) {
+        throw std::runtime_error("write " + path + " failure");
+    }
+}
+
+BenchmarkStats BenchmarkHarness::computeStats(std::vector<double> samples) {
+    BenchmarkStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const size_t count = samples.size();
+    stats.min = samples.front();
+    stats.max = samples.back();
+    stats.median = count % 2 == 1 ? samples[count / 2]
+                                   : 0.5 * (samples[count / 2 - 1] + samples[count / 2]);
+    stats.p90 = samples[std::min(count - 1, static_cast<size_t>(std::ceil(0.9 * count)) - 1)];
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+
+    double variance = 0.0;
+    for (double sample : samples) {
+        variance += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = count > 1 ? std::sqrt(variance / (count - 1)) : 0.0;
+
+    return stats;
+}
+
+namespace {
+// written through volatile so that the compiler must produce the pointer's value
+const void* volatile sink = nullptr;
+}  // namespace
+
+void doNotOptimize(const void* pointer) {
+    sink = pointer;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// times per run in microseconds
+struct BenchmarkStats {
+    double min = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p90 = 0.0;
+    double max = 0.0;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t itemsPerRun = 1;
+    std::vector<double> samples;
+    BenchmarkStats stats;
+};
+
+// Runs each benchmark a few times untimed to warm caches and lazily built state, then
+// times every repetition separately so the spread is visible, not just the average.
+class BenchmarkHarness {
+public:
+    // only benchmarks whose name contains filter are run
+    BenchmarkHarness(int warmupRuns, int repetitions, const std::string& filter);
+
+    bool isEnabled(const std::string& name) const;
+
+    // itemsPerRun is how many operations one call of function does, for the throughput
+    void run(const std::string& name, const std::function<void()>& function, size_t itemsPerRun = 1);
+
+    const std::vector<BenchmarkResult>& getResults() const {
+        return _results;
+    }
+
+    void writeJson(const std::string& path) const;
+
+    static BenchmarkStats computeStats(std::vector<double> samples);
+
+private:
+    int _warmupRuns;
+    int _repetitions;
+    std::string _filter;
+    std::vector<BenchmarkResult> _results;
+};
+
+// keeps the compiler from dropping a computation whose result is otherwise unused
+void doNotOptimize(const void* pointer);
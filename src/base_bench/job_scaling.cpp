@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../base/job_system.h"
+#include "job_scaling.h"
+
+namespace {
+struct BenchBullet {
+    glm::vec3 position;
+    glm::vec3 previousPosition;
+    glm::vec3 velocity;
+    bool active;
+};
+
+struct Workload {
+    std::string name;
+    std::function<void(JobSystem&)> run;
+};
+
+// median wall time in milliseconds of a few repetitions after one warmup run
+double measure(JobSystem& jobSystem, const Workload& workload, int repetitions) {
+    workload.run(jobSystem);
+
+    std::vector<double> samples;
+    for (int i = 0; i < repetitions; ++i) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        workload.run(jobSystem);
+        const auto end = std::chrono::high_resolution_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+} // namespace
+
+void runJobScaling(int maxThreads) {
+    const int repetitions = 9;
+
+    // memory bound, the same integration as GameWorld::updateBullets
+    std::vector<BenchBullet> bullets(1 << 20);
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        bullets[i].position = glm::vec3(0.0f);
+        bullets[i].previousPosition = glm::vec3(0.0f);
+        bullets[i].velocity = glm::normalize(glm::vec3(std::cos(i * 0.1f), 0.0f, std::sin(i * 0.1f)));
+        bullets[i].active = true;
+    }
+
+    // compute bound
+    std::vector<float> values(1 << 18, 1.0f);
+
+    const std::vector<Workload> workloads = {
+        {"bullet update (1M)",
+         [&bullets](JobSystem& jobSystem) {
+             jobSystem.parallelFor(bullets.size(), 1024, [&bullets](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; ++i) {
+                     BenchBullet& bullet = bullets[i];
+                     bullet.previousPosition = bullet.position;
+                     bullet.position += bullet.velocity * (1.0f / 60.0f);
+                     if (glm::length(bullet.position) > 20.0f) {
+                         bullet.position = glm::vec3(0.0f);
+                     }
+                 }
+             });
+         }},
+        {"transcendental (256K x 64)",
+         [&values](JobSystem& jobSystem) {
+             jobSystem.parallelFor(values.size(), 256, [&values](size_t begin, size_t end) {
+                 for (size_t i = begin; i < end; ++i) {
+                     float x = values[i];
+                     for (int k = 0; k < 64; ++k) {
+                         x = std::sin(x) + std::cos(x * 0.5f);
+                     }
+                     values[i] = x;
+                 }
+             });
+         }},
+        {"task graph (16K jobs)",
+         [](JobSystem& jobSystem) {
+             std::vector<JobSystem::JobHandle> jobs;
+             jobs.reserve(16384);
+             for (int i = 0; i < 16384; ++i) {
+                 jobs.push_back(jobSystem.schedule([]() {
+                     volatile float x = 1.0f;
+                     for (int k = 0; k < 256; ++k) {
+                         x = x * 1.0001f;
+                     }
+                 }));
+             }
+             jobSystem.wait(jobSystem.schedule([]() {}, jobs));
+         }},
+    };
+
+    std::printf("job system scaling, median of %d runs\n", repetitions);
+    for (const auto& workload : workloads) {
+        std::printf("\n%s\n", workload.name.c_str());
+        std::printf("%8s %12s %10s %12s\n", "threads", "time (ms)", "speedup", "efficiency");
+
+        double baseline = 0.0;
+        for (int threads = 1; threads <= maxThreads; ++threads) {
+            // the calling thread takes part in parallelFor and wait, so it counts as one
+            JobSystem jobSystem(threads - 1);
+            const double time = measure(jobSystem, workload, repetitions);
+            if (threads == 1) {
+                baseline = time;
+            }
+
+            const double speedup = baseline / time;
+            std::printf(
+                "%8d %12.3f %9.2fx %11.0f%%\n", threads, time, speedup, 100.0 * speedup / threads);
+        }
+    }
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// prints the speedup of the job system over 1..maxThreads threads for a few workloads
+void runJobScaling(int maxThreads);
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../base/frame_rate_indicator.h"
+#include "../base/job_system.h"
+#include "../base/model.h"
+#include "../get_start/game_world.h"
+#include "../get_start/text_layout.h"
+#include "bench_harness.h"
+#include "job_scaling.h"
+
+namespace {
+struct BenchOptions {
+    std::string jsonPath;
+    std::string filter;
+    std::string mediaDir = "../../media/";
+    int warmupRuns = 3;
+    int repetitions = 30;
+    int scalingThreads = 0;
+};
+
+void printUsage() {
+    std::cout << "usage: base_bench [--json file] [--filter text] [--warmup n] [--repetitions n] "
+                 "[--media dir]\n"
+                 "       base_bench --scaling [max threads]"
+              << std::endl;
+}
+
+// a game world that keeps about bulletCount bullets alive, the same setup as the headless target
+void fillWorld(GameWorld& world, int launchers, int bulletCount) {
+    GameParams params;
+    params.initialLaunchers = launchers;
+    const float lifetime = (params.launcherRadius + 20.0f) / params.bulletSpeed;
+    params.fireInterval = launchers * lifetime / bulletCount;
+    params.waveTime = 1.0e9f;
+
+    world.restart(params);
+    world.setInvulnerable(true);
+
+    SimulationEvent start;
+    start.type = SimulationEventType::StartGame;
+    world.applyEvent(start);
+
+    const float deltaTime = 1.0f / 60.0f;
+    for (int i = 0; i < static_cast<int>(lifetime / deltaTime) + 1; ++i) {
+        world.tick(deltaTime);
+    }
+}
+
+// printable ascii with the metrics of a 48px font, no freetype needed
+std::map<char, Character> makeFakeFont() {
+    std::map<char, Character> characters;
+    for (char c = 32; c < 127; ++c) {
+        Character character;
+        character.TextureID = static_cast<GLuint>(c);
+        character.Size = glm::ivec2(24 + c % 7, 34 + c % 5);
+        character.Bearing = glm::ivec2(c % 3, 30 + c % 4);
+        character.Advance = static_cast<GLuint>((26 + c % 6) << 6);
+        characters[c] = character;
+    }
+    return characters;
+}
+
+void benchModels(BenchmarkHarness& harness, const std::string& mediaDir) {
+    const std::vector<std::string> assets = {
+        "obj/cube.obj", "obj/sphere.obj", "obj/arrow.obj", "obj/muzzle_flash.obj",
+        "obj/knot.obj", "obj/rock.obj",   "obj/turret01.obj", "obj/turret02.obj"};
+
+    for (const auto& asset : assets) {
+        harness.run("model import " + asset, [&]() {
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+            Model::importMesh(mediaDir + asset, vertices, indices);
+            doNotOptimize(vertices.data());
+        });
+    }
+
+    // the turret animation blends these two every frame
+    if (harness.isEnabled("model interpolate turret")) {
+        std::vector<Vertex> turret0, turret1;
+        std::vector<uint32_t> turretIndices;
+        Model::importMesh(mediaDir + "obj/turret01.obj", turret0, turretIndices);
+        turretIndices.clear();
+        Model::importMesh(mediaDir + "obj/turret02.obj", turret1, turretIndices);
+        harness.run("model interpolate turret", [&]() {
+            std::vector<Vertex> blended = Model::interpolateVertices(turret0, turret1, 0.37f);
+            doNotOptimize(blended.data());
+        }, turret0.size());
+    }
+
+    // welding an unindexed triangle soup is the worst case the importer sees
+    if (harness.isEnabled("vertex weld knot")) {
+        std::vector<Vertex> knotVertices;
+        std::vector<uint32_t> knotIndices;
+        Model::importMesh(mediaDir + "obj/knot.obj", knotVertices, knotIndices);
+        std::vector<Vertex> soup;
+        std::vector<uint32_t> corners;
+        for (uint32_t index : knotIndices) {
+            corners.push_back(static_cast<uint32_t>(soup.size()));
+            soup.push_back(knotVertices[index]);
+        }
+        harness.run("vertex weld knot", [&]() {
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+            std::unordered_map<Vertex, uint32_t> uniqueVertices;
+            Model::weldVertices(soup, corners, vertices, indices, uniqueVertices);
+            doNotOptimize(indices.data());
+        }, soup.size());
+    }
+}
+
+void benchWorld(BenchmarkHarness& harness, JobSystem& jobSystem) {
+    const int bulletCounts[] = {1000, 10000, 100000};
+    for (int bullets : bulletCounts) {
+        const std::string suffix = " (" + std::to_string(bullets) + " bullets)";
+        if (harness.isEnabled("world tick" + suffix) || harness.isEnabled("world tick jobs" + suffix)
+            || harness.isEnabled("ray pick" + suffix)) {
+            GameWorld serialWorld;
+            fillWorld(serialWorld, 256, bullets);
+            harness.run("world tick" + suffix, [&]() { serialWorld.tick(1.0f / 60.0f); },
+                        serialWorld.getBulletCount());
+
+            GameWorld jobWorld(&jobSystem);
+            fillWorld(jobWorld, 256, bullets);
+            harness.run("world tick jobs" + suffix, [&]() { jobWorld.tick(1.0f / 60.0f); },
+                        jobWorld.getBulletCount());
+
+            // rays from the player in a fan around the ring, as clicks would cast them
+            const int rayCount = 64;
+            harness.run("ray pick" + suffix, [&]() {
+                int hits = 0;
+                for (int i = 0; i < rayCount; ++i) {
+                    const float angle = 6.2831853f * i / rayCount;
+                    const glm::vec3 direction(std::cos(angle), 0.0f, std::sin(angle));
+                    hits += serialWorld.pickBullet(glm::vec3(0.0f, 1.0f, 0.0f), direction) >= 0;
+                }
+                doNotOptimize(&hits);
+            }, rayCount);
+        }
+    }
+}
+
+void benchText(BenchmarkHarness& harness) {
+    const std::map<char, Character> font = makeFakeFont();
+    const std::vector<std::string> lines = {
+        "Wave: 12", "Time: 23.5s", "Health: 3", "Bullets: 104857", "Press ENTER to start",
+        "Wave 12 complete! Next wave in 4.2 seconds"};
+
+    std::vector<GlyphQuad> quads;
+    size_t glyphCount = 0;
+    for (const auto& line : lines) {
+        glyphCount += line.size();
+    }
+
+    harness.run("text layout hud", [&]() {
+        for (const auto& line : lines) {
+            layoutText(font, line, 20.0f, 1040.0f, 0.6f, quads);
+            doNotOptimize(quads.data());
+        }
+    }, glyphCount);
+}
+
+void benchFrameRateIndicator(BenchmarkHarness& harness) {
+    FrameRateIndicator indicator(64);
+    const int pushes = 10000;
+    harness.run("fps indicator push", [&]() {
+        for (int i = 0; i < pushes; ++i) {
+            indicator.push(60.0f + (i & 7));
+        }
+        doNotOptimize(indicator.getDataPtr());
+    }, pushes);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            options.warmupRuns = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--media") == 0 && hasValue) {
+            options.mediaDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--scaling") == 0) {
+            // defaults to the hardware thread count; the value is optional, so a following
+            // flag is not taken for it
+            options.scalingThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            if (hasValue && std::strncmp(argv[i + 1], "--", 2) != 0) {
+                options.scalingThreads = std::max(1, std::atoi(argv[++i]));
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (options.scalingThreads > 0) {
+        runJobScaling(options.scalingThreads);
+        return 0;
+    }
+
+    try {
+        JobSystem jobSystem;
+        BenchmarkHarness harness(options.warmupRuns, options.repetitions, options.filter);
+
+        benchModels(harness, options.mediaDir);
+        benchWorld(harness, jobSystem);
+        benchText(harness);
+        benchFrameRateIndicator(harness);
+
+        if (!options.jsonPath.empty()) {
+            harness.writeJson(options.jsonPath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
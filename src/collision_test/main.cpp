@@ -0,0 +1,94 @@
+#include <iostream>
+
+#include "../base/collision.h"
+#include "../get_start/game_world.h"
+
+namespace {
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// a bullet that moves from previous to current in a single tick
+Bullet makeBullet(const glm::vec3& previous, const glm::vec3& current) {
+    Bullet bullet;
+    bullet.previousPosition = previous;
+    bullet.position = current;
+    bullet.velocity = current - previous;
+    return bullet;
+}
+
+Player makePlayer(const glm::vec3& previous, const glm::vec3& current) {
+    Player player;
+    player.previousPosition = previous;
+    player.position = current;
+    return player;
+}
+
+// what the game did before the swept test: only the end of the tick overlaps
+bool overlapsAtEnd(const Bullet& bullet, const Player& player) {
+    return glm::length(bullet.position - player.position) < bullet.radius + player.radius;
+}
+}  // namespace
+
+// Fast bullets against the player in one large-dt tick, deterministic and without GL.
+int main() {
+    {
+        // crosses the standing player completely within the tick
+        const Bullet bullet = makeBullet({-10.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f});
+        const Player player = makePlayer({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+        check(!overlapsAtEnd(bullet, player), "tunneling setup: no overlap at the end of the tick");
+        check(GameWorld::isPlayerHit(bullet, player), "bullet crossing a standing player hits");
+    }
+
+    {
+        // the player moves up through the bullet's path while it passes: they meet at half
+        // the tick, while neither the start nor the end positions overlap
+        const Bullet bullet = makeBullet({-10.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f});
+        const Player player = makePlayer({0.0f, -1.0f, 0.0f}, {0.0f, 1.0f, 0.0f});
+        check(!overlapsAtEnd(bullet, player), "moving setup: no overlap at the end of the tick");
+        check(GameWorld::isPlayerHit(bullet, player), "bullet crossing a vertically moving player hits");
+    }
+
+    {
+        // passes just above the standing player
+        const Player player = makePlayer({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+        const float clearance = player.radius + Bullet().radius + 0.05f;
+        const Bullet bullet = makeBullet({-10.0f, clearance, 0.0f}, {10.0f, clearance, 0.0f});
+        check(!GameWorld::isPlayerHit(bullet, player), "near miss above a standing player");
+    }
+
+    {
+        // the player moves down and away below the path: at half the tick the spheres are
+        // still 0.05 apart, and further apart at any other time
+        const Bullet bullet = makeBullet({-10.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f});
+        const float gap = Player().radius + Bullet().radius + 0.05f;
+        const Player player = makePlayer({0.0f, -gap + 0.5f, 0.0f}, {0.0f, -gap - 0.5f, 0.0f});
+        check(!GameWorld::isPlayerHit(bullet, player), "near miss of a vertically moving player");
+    }
+
+    {
+        // the bullet stops one radius short of the player
+        const Bullet bullet = makeBullet({-10.0f, 0.0f, 0.0f}, {-0.75f, 0.0f, 0.0f});
+        const Player player = makePlayer({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f});
+        check(!GameWorld::isPlayerHit(bullet, player), "bullet stopping short of the player");
+    }
+
+    {
+        float timeOfImpact = -1.0f;
+        check(sweptSphereIntersection({-10.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, 0.2f,
+                                      {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 0.5f, timeOfImpact),
+              "swept spheres hit");
+        // first contact at x = -0.7, i.e. 9.3 of 20 units into the tick
+        check(std::abs(timeOfImpact - 9.3f / 20.0f) < 1e-5f, "time of impact at first contact");
+    }
+
+    if (failures == 0) {
+        std::cout << "all collision checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "../base/camera.h"
+#include "../base/frustum_culling.h"
+
+namespace {
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// a camera that looks down and to the side, so that no plane lines up with an axis
+PerspectiveCamera makeCamera() {
+    PerspectiveCamera camera(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    camera.transform.position = glm::vec3(3.0f, 6.0f, 12.0f);
+    camera.transform.lookAt(glm::vec3(-5.0f, 0.0f, -20.0f));
+    return camera;
+}
+
+glm::vec3 randomVec3(std::mt19937& random, float low, float high) {
+    std::uniform_real_distribution<float> distribution(low, high);
+    const float x = distribution(random);
+    const float y = distribution(random);
+    const float z = distribution(random);
+    return glm::vec3(x, y, z);
+}
+
+glm::mat4 randomTRS(std::mt19937& random, const glm::vec3& center) {
+    std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), center + randomVec3(random, -5.0f, 5.0f));
+    model = glm::rotate(model, angle(random), glm::normalize(randomVec3(random, 0.1f, 1.0f)));
+    return glm::scale(model, randomVec3(random, 0.2f, 3.0f));
+}
+}  // namespace
+
+// The SSE batch tests against the scalar Frustum::intersect(), and the perspective frustum
+// against clip space. Deterministic and without GL.
+int main() {
+    const PerspectiveCamera camera = makeCamera();
+    const Frustum& frustum = camera.getFrustum();
+    const glm::vec3 lookCenter = camera.transform.position + 50.0f * camera.transform.getFront();
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> radius(0.05f, 4.0f);
+
+    {
+        // not a multiple of four, so that the scalar tail runs as well
+        const size_t count = 10003;
+        BoundingSpheres spheres;
+        for (size_t i = 0; i < count; ++i) {
+            spheres.add(lookCenter + randomVec3(random, -70.0f, 70.0f), radius(random));
+        }
+
+        std::vector<uint8_t> visible;
+        const size_t culled = cullSpheres(frustum, spheres, visible);
+
+        size_t mismatches = 0;
+        size_t expectedCulled = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 center(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]);
+            const bool expected = frustum.intersect(center, spheres.radius[i]);
+            mismatches += (visible[i] != 0) != expected ? 1 : 0;
+            expectedCulled += expected ? 0 : 1;
+        }
+        check(visible.size() == count, "one visibility flag per sphere");
+        check(mismatches == 0, "cullSpheres() agrees with Frustum::intersect()");
+        check(culled == expectedCulled, "cullSpheres() counts the culled spheres");
+        check(culled > 0 && culled < count, "the spheres are partly culled");
+    }
+
+    {
+        const size_t count = 10002;
+        BoundingBox box;
+        box.min = glm::vec3(-0.5f, -1.0f, -0.25f);
+        box.max = glm::vec3(0.5f, 1.0f, 0.75f);
+
+        BoundingBoxes boxes;
+        std::vector<glm::mat4> models;
+        for (size_t i = 0; i < count; ++i) {
+            models.push_back(randomTRS(random, lookCenter + randomVec3(random, -70.0f, 70.0f)));
+            boxes.add(box, models.back());
+        }
+
+        std::vector<uint8_t> visible;
+        const size_t culled = cullBoxes(frustum, boxes, visible);
+
+        size_t mismatches = 0;
+        size_t expectedCulled = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const bool expected = frustum.intersect(box, models[i]);
+            mismatches += (visible[i] != 0) != expected ? 1 : 0;
+            expectedCulled += expected ? 0 : 1;
+        }
+        check(mismatches == 0, "cullBoxes() agrees with Frustum::intersect()");
+        check(culled == expectedCulled, "cullBoxes() counts the culled boxes");
+        check(culled > 0 && culled < count, "the boxes are partly culled");
+    }
+
+    {
+        // a point is inside the frustum exactly when it is inside the clip volume; points
+        // closer to a clip plane than float precision can tell are skipped
+        const glm::mat4& viewProjection = camera.getViewProjectionMatrix();
+        size_t misclassified = 0;
+        size_t inside = 0;
+        for (int i = 0; i < 200000; ++i) {
+            const glm::vec3 point = lookCenter + randomVec3(random, -70.0f, 70.0f);
+            const glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+            const float margin = std::min(
+                std::min(clip.w - std::abs(clip.x), clip.w - std::abs(clip.y)),
+                clip.w - std::abs(clip.z));
+            if (std::abs(margin) < 1e-3f * std::max(std::abs(clip.w), 1.0f)) {
+                continue;
+            }
+
+            const bool expected = margin > 0.0f;
+            misclassified += frustum.intersect(point, 0.0f) != expected ? 1 : 0;
+            inside += expected ? 1 : 0;
+        }
+        check(misclassified == 0, "perspective frustum matches the clip volume");
+        check(inside > 0, "some points are inside the clip volume");
+    }
+
+    if (failures == 0) {
+        std::cout << "all culling checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include "benchmark.h"
+
+namespace {
+void writeStats(std::ofstream& out, const char* name, const std::vector<float>& samples) {
+    const FrameTimeStats stats = computeFrameTimeStats(samples);
+    out << "        \"" << name << "\": {\"p50\": " << stats.p50 << ", \"p90\": " << stats.p90
+        << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << ", \"mean\": " << stats.mean
+        << "}";
+}
+
+// per frame averages, the interesting part is how they grow with the bullet count
+void writeGLCalls(std::ofstream& out, const GLCallCounts& counts, size_t frames) {
+    out << "      \"gl_calls_per_frame\": {\n";
+    for (int i = 0; i < kGLCallCategoryCount; ++i) {
+        const GLCallCategory category = static_cast<GLCallCategory>(i);
+        out << "        \"" << GLCallStats::getCategoryName(category) << "\": {\"calls\": "
+            << static_cast<double>(counts.getCalls(category)) / frames << ", \"redundant\": "
+            << static_cast<double>(counts.getRedundant(category)) / frames << "},\n";
+    }
+    out << "        \"upload_bytes\": " << static_cast<double>(counts.uploadBytes) / frames << "\n";
+    out << "      }";
+}
+} // namespace
+
+std::vector<BenchmarkStage> getDefaultBenchmarkStages() {
+    return {
+        {8, 50},
+        {32, 1000},
+        {128, 10000},
+        {512, 50000},
+        {1024, 100000},
+        {2048, 200000},
+        {4096, 300000},
+    };
+}
+
+FrameTimeStats computeFrameTimeStats(std::vector<float> samples) {
+    FrameTimeStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](float p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    stats.p50 = percentile(0.50f);
+    stats.p90 = percentile(0.90f);
+    stats.p99 = percentile(0.99f);
+    stats.max = samples.back();
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
+    return stats;
+}
+
+void writeBenchmarkReport(
+    const std::string& path, float simulationRate, const std::vector<BenchmarkStageResult>& results,
+    const UniformOverheadResult& uniformOverhead) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("open " + path + " for writing failure");
+    }
+
+    out << "{\n";
+#ifdef NDEBUG
+    out << "  \"build\": \"release\",\n";
+#else
+    out << "  \"build\": \"debug\",\n";
+#endif
+    out << "  \"simulation_rate\": " << simulationRate << ",\n";
+    out << "  \"stages\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkStageResult& result = results[i];
+        const FrameTimeStats bullets = computeFrameTimeStats(result.bulletCounts);
+
+        out << "    {\n";
+        out << "      \"launchers\": " << result.stage.launchers << ",\n";
+        out << "      \"target_bullets\": " << result.stage.targetBullets << ",\n";
+        out << "      \"frames\": " << result.frameTimes.size() << ",\n";
+        out << "      \"bullets\": {\"mean\": " << bullets.mean << ", \"max\": " << bullets.max
+            << "},\n";
+        out << "      \"ms\": {\n";
+        writeStats(out, "frame", result.frameTimes);
+        out << ",\n";
+        writeStats(out, "simulation", result.simulationTimes);
+        out << ",\n";
+        writeStats(out, "render_cpu", result.renderTimes);
+        out << ",\n";
+        writeStats(out, "swap", result.swapTimes);
+        if (!result.gpuTimes.empty()) {
+            out << ",\n";
+            writeStats(out, "gpu", result.gpuTimes);
+        }
+        out << "\n      }";
+        if (GLCallStats::isEnabled() && !result.frameTimes.empty()) {
+            out << ",\n";
+            writeGLCalls(out, result.glCalls, result.frameTimes.size());
+        }
+        out << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]";
+    if (uniformOverhead.draws > 0) {
+        out << ",\n";
+        out << "  \"uniform_overhead_ns_per_draw\": {\"draws\": " << uniformOverhead.draws
+            << ", \"location_lookup\": " << uniformOverhead.locationLookupNs
+            << ", \"name_lookup\": " << uniformOverhead.nameLookupNs
+            << ", \"handle\": " << uniformOverhead.handleNs << "}";
+    }
+    out << "\n}\n";
+
+    if (!out) {
+        throw std::runtime_error("write " + path + " failure");
+    }
+}
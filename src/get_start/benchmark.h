@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../base/gl_call_stats.h"
+
+// One step of the benchmark ramp: the launcher count and how many bullets they keep alive.
+struct BenchmarkStage {
+    int launchers;
+    int targetBullets;
+};
+
+struct FrameTimeStats {
+    float p50 = 0.0f;
+    float p90 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    float mean = 0.0f;
+};
+
+// per-frame samples of one stage, all times in milliseconds
+struct BenchmarkStageResult {
+    BenchmarkStage stage;
+    std::vector<float> frameTimes;
+    std::vector<float> simulationTimes;
+    std::vector<float> renderTimes;
+    std::vector<float> swapTimes;
+    // empty when the driver has no timer queries
+    std::vector<float> gpuTimes;
+    std::vector<float> bulletCounts;
+    // summed over the stage's frames, zero unless built with GL_CALL_STATS
+    GLCallCounts glCalls;
+};
+
+// cpu time of one bullet draw with its four uniforms, by how the uniforms are set
+struct UniformOverheadResult {
+    int draws = 0;
+    // glGetUniformLocation for every uniform, what the setters by name used to do
+    float locationLookupNs = 0.0f;
+    // setters by name, looked up in the table reflected at link time
+    float nameLookupNs = 0.0f;
+    float handleNs = 0.0f;
+};
+
+// ramps from tens to hundreds of thousands of bullets
+std::vector<BenchmarkStage> getDefaultBenchmarkStages();
+
+// nearest-rank percentiles
+FrameTimeStats computeFrameTimeStats(std::vector<float> samples);
+
+void writeBenchmarkReport(
+    const std::string& path, float simulationRate, const std::vector<BenchmarkStageResult>& results,
+    const UniformOverheadResult& uniformOverhead);
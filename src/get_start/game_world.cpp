@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "../base/collision.h"
+#include "../base/tracer.h"
+#include "game_world.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+// FNV-1a over the raw bytes of the values added
+class StateHasher {
+public:
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be hashed");
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            _hash = (_hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+
+    uint64_t get() const {
+        return _hash;
+    }
+
+private:
+    uint64_t _hash = 14695981039346656037ull;
+};
+} // namespace
+
+GameWorld::GameWorld(JobSystem* jobSystem) : _jobSystem(jobSystem) {
+    reset();
+}
+
+void GameWorld::applyEvent(const SimulationEvent& event) {
+    switch (event.type) {
+    case SimulationEventType::StartGame: start(); break;
+    case SimulationEventType::ResetGame: reset(); break;
+    case SimulationEventType::Move: _moveAxis = event.moveAxis; break;
+    case SimulationEventType::Fire: fireAt(event.rayOrigin, event.rayDirection); break;
+    case SimulationEventType::SetParams: {
+        const bool intervalChanged = event.params.fireInterval != _params.fireInterval;
+        _params = event.params;
+        if (intervalChanged) {
+            for (auto& launcher : _launchers) {
+                launcher.fireInterval = _params.fireInterval;
+            }
+            rescheduleLaunchers();
+        }
+        break;
+    }
+    }
+}
+
+void GameWorld::tick(float deltaTime) {
+    TRACE_SCOPE("GameWorld::tick");
+    _deltaTime = deltaTime;
+    _player.previousPosition = _player.position;
+    updatePlayer();
+    updateGame();
+    ++_tick;
+}
+
+void GameWorld::writeSnapshot(SceneSnapshot& snapshot) const {
+    TRACE_SCOPE("GameWorld::writeSnapshot");
+    snapshot.gameState = _gameState;
+    snapshot.gameTime = _gameTime;
+    snapshot.currentWave = _currentWave;
+    snapshot.waveTime = _params.waveTime;
+    snapshot.waveTimer = _waveTimer;
+    snapshot.breakTime = _breakTime;
+    snapshot.breakTimer = _breakTimer;
+    snapshot.showStartText = _showStartText;
+    snapshot.playerPosition = _player.position;
+    snapshot.playerPreviousPosition = _player.previousPosition;
+    snapshot.playerRadius = _player.radius;
+    snapshot.playerHealth = _player.health;
+
+    // the buffers keep their capacity, so this does not allocate once the wave has ramped up
+    snapshot.bullets.clear();
+    for (const auto& bullet : _bullets) {
+        if (!bullet.active) continue;
+        BulletSnapshot b;
+        b.position = bullet.position;
+        b.previousPosition = bullet.previousPosition;
+        b.color = bullet.color;
+        b.radius = bullet.radius;
+        b.destroying = bullet.destroying;
+        b.destroyProgress = bullet.destroyTimer / bullet.destroyDuration;
+        snapshot.bullets.push_back(b);
+    }
+
+    if (snapshot.launchersVersion != _launchersVersion) {
+        snapshot.launchers.clear();
+        for (const auto& launcher : _launchers) {
+            snapshot.launchers.push_back({launcher.position});
+        }
+        snapshot.launchersVersion = _launchersVersion;
+    }
+}
+
+void GameWorld::restart(const GameParams& params) {
+    _params = params;
+    _moveAxis = 0.0f;
+    reset();
+    _tick = 0;
+}
+
+uint64_t GameWorld::computeStateHash() const {
+    StateHasher hasher;
+    hasher.add(_gameState);
+    hasher.add(_gameTime);
+    hasher.add(_currentWave);
+    hasher.add(_waveTimer);
+    hasher.add(_breakTimer);
+    hasher.add(_player.position);
+    hasher.add(_player.health);
+    for (const auto& bullet : _bullets) {
+        hasher.add(bullet.position);
+        hasher.add(bullet.velocity);
+        hasher.add(bullet.active);
+        hasher.add(bullet.destroying);
+        hasher.add(bullet.destroyTimer);
+    }
+    for (const auto& launcher : _launchers) {
+        hasher.add(launcher.position);
+        hasher.add(launcher.lastFireTime);
+    }
+    return hasher.get();
+}
+
+void GameWorld::reset() {
+    _gameState = GameState::WaitingToStart;
+    _gameTime = 0.0f;
+    _currentWave = 1;
+    _waveTimer = 0.0f;
+    _breakTimer = 0.0f;
+    _player.health = 3;
+    _player.position = glm::vec3(0.0f, 0.0f, 0.0f);
+    _player.previousPosition = _player.position;
+    _bullets.clear();
+    _blinkTimer = 0.0f;
+    _showStartText = true;
+    setupLaunchers(_params.initialLaunchers);
+}
+
+void GameWorld::start() {
+    // enter may be held for several frames before the snapshot catches up
+    if (_gameState != GameState::WaitingToStart) return;
+
+    _gameState = GameState::Playing;
+    _gameTime = 0.0f;
+    _waveTimer = 0.0f;
+    setupLaunchers(_params.initialLaunchers);
+}
+
+void GameWorld::updatePlayer() {
+    float moveSpeed = 5.0f;
+    if (_gameState == GameState::Playing) {
+        _player.position.y += _moveAxis * moveSpeed * _deltaTime;
+        _player.position.y = glm::clamp(_player.position.y, -_player.moveRange, _player.moveRange);
+    }
+}
+
+void GameWorld::updateGame() {
+    TRACE_SCOPE("GameWorld::updateGame");
+    if (_gameState == GameState::Playing) {
+        _gameTime += _deltaTime;
+        _waveTimer += _deltaTime;
+
+        updateBullets();
+        updateLaunchers();
+        checkCollisions();
+        handleWaveTransition();
+    } else if (_gameState == GameState::WaitingToStart) {
+        updateWaitingState();
+    } else if (_gameState == GameState::WaveBreak) {
+        _breakTimer += _deltaTime;
+        updateBullets();
+
+        // 休息时间结束后开始下一波
+        if (_breakTimer >= _breakTime) {
+            _currentWave++;
+            _waveTimer = 0.0f;
+            _gameState = GameState::Playing;
+
+            int newLauncherCount =
+                _params.initialLaunchers + (_currentWave - 1) * _params.launchersPerWave;
+            setupLaunchers(newLauncherCount);
+        }
+    }
+}
+
+void GameWorld::updateBullets() {
+    TRACE_SCOPE("GameWorld::updateBullets");
+    auto integrate = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Bullet& bullet = _bullets[i];
+            if (!bullet.active) continue;
+
+            bullet.previousPosition = bullet.position;
+            if (bullet.destroying) {
+                bullet.destroyTimer += _deltaTime;
+                if (bullet.destroyTimer >= bullet.destroyDuration) {
+                    bullet.active = false;
+                }
+            } else {
+                bullet.position += bullet.velocity * _deltaTime;
+
+                float distanceFromCenter = glm::length(bullet.position);
+                if (distanceFromCenter > 20.0f) {
+                    bullet.active = false;
+                }
+            }
+        }
+    };
+
+    // bullets are independent of each other, integrate them in batches on the workers
+    if (_jobSystem != nullptr) {
+        _jobSystem->parallelFor(_bullets.size(), 1024, integrate);
+    } else {
+        integrate(0, _bullets.size());
+    }
+
+    _bullets.erase(
+        std::remove_if(
+            _bullets.begin(), _bullets.end(), [](const Bullet& b) { return !b.active; }),
+        _bullets.end());
+}
+
+void GameWorld::updateLaunchers() {
+    TRACE_SCOPE("GameWorld::updateLaunchers");
+    // 只处理到期的发射器，发射间隔变化时由rescheduleLaunchers重新排期
+    _launcherSchedule.runDue(_gameTime, [this](uint32_t index, float) {
+        Launcher& launcher = _launchers[index];
+        spawnBullet(launcher);
+        launcher.lastFireTime = _gameTime;
+        _launcherSchedule.schedule(index, _gameTime + launcher.fireInterval);
+    });
+}
+
+void GameWorld::updateWaitingState() {
+    _blinkTimer += _deltaTime;
+    if (_blinkTimer >= 0.8f) {
+        _showStartText = !_showStartText;
+        _blinkTimer = 0.0f;
+    }
+}
+
+void GameWorld::rescheduleLaunchers() {
+    _launcherSchedule.clear();
+    for (size_t i = 0; i < _launchers.size(); ++i) {
+        const Launcher& launcher = _launchers[i];
+        _launcherSchedule.schedule(
+            static_cast<uint32_t>(i), launcher.lastFireTime + launcher.fireInterval);
+    }
+}
+
+void GameWorld::setupLaunchers(int count) {
+    _launchers.clear();
+
+    for (int i = 0; i < count; ++i) {
+        Launcher launcher;
+        float angle = (2.0f * M_PI * i) / count;
+        launcher.position = glm::vec3(
+            _params.launcherRadius * cos(angle), 0.0f, _params.launcherRadius * sin(angle));
+        launcher.fireInterval = _params.fireInterval;
+
+        // 错开发射，但保持相同的发射频率
+        float timeOffset = (_params.fireInterval * i) / count;
+        launcher.lastFireTime = _gameTime - _params.fireInterval + timeOffset;
+
+        _launchers.push_back(launcher);
+    }
+
+    rescheduleLaunchers();
+    ++_launchersVersion;
+}
+
+void GameWorld::spawnBullet(const Launcher& launcher) {
+    const glm::vec3 launcherPosition(launcher.position.x, _player.position.y, launcher.position.z);
+
+    Bullet bullet;
+    bullet.position = launcherPosition;
+    bullet.previousPosition = launcherPosition;
+
+    glm::vec3 direction = glm::normalize(_player.position - launcherPosition);
+    bullet.velocity = direction * _params.bulletSpeed;
+    bullet.color = glm::vec3(1.0f, 0.8f, 0.2f);
+    bullet.active = true;
+
+    _bullets.push_back(bullet);
+}
+
+void GameWorld::checkCollisions() {
+    TRACE_SCOPE("GameWorld::checkCollisions");
+    if (_invulnerable) return;
+
+    for (const auto& bullet : _bullets) {
+        if (!bullet.active) continue;
+
+        if (!bullet.destroying && isPlayerHit(bullet, _player)) {
+            takeDamage();
+            break;
+        }
+    }
+}
+
+bool GameWorld::isPlayerHit(const Bullet& bullet, const Player& player) {
+    // sweep both spheres over the last tick so that fast bullets cannot tunnel through
+    float timeOfImpact;
+    return sweptSphereIntersection(
+        bullet.previousPosition, bullet.position, bullet.radius, player.previousPosition,
+        player.position, player.radius, timeOfImpact);
+}
+
+void GameWorld::takeDamage() {
+    _player.health--;
+    if (_player.health <= 0) {
+        _gameState = GameState::GameOver;
+    }
+
+    // 让所有活跃子弹开始销毁动画，而不是直接清空
+    for (auto& bullet : _bullets) {
+        if (bullet.active && !bullet.destroying) {
+            bullet.destroying = true;
+            bullet.destroyTimer = 0.0f;
+        }
+    }
+}
+
+void GameWorld::handleWaveTransition() {
+    if (_waveTimer >= _params.waveTime) {
+        _gameState = GameState::WaveBreak;
+        _breakTimer = 0.0f;
+        _breakTime = _params.waveBreakTime;
+
+        // 让所有活跃子弹开始销毁动画，而不是直接清空
+        for (auto& bullet : _bullets) {
+            if (bullet.active && !bullet.destroying) {
+                bullet.destroying = true;
+                bullet.destroyTimer = 0.0f;
+            }
+        }
+    }
+}
+
+void GameWorld::fireAt(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) {
+    const int closestBulletIndex = pickBullet(rayOrigin, rayDirection);
+    if (closestBulletIndex >= 0) {
+        startBulletDestroy(closestBulletIndex);
+    }
+}
+
+int GameWorld::pickBullet(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+    float closestDistance = std::numeric_limits<float>::max();
+    int closestBulletIndex = -1;
+
+    for (size_t i = 0; i < _bullets.size(); ++i) {
+        const auto& bullet = _bullets[i];
+        if (!bullet.active || bullet.destroying) continue;
+
+        float effectiveRadius = bullet.radius * 2.0f;
+
+        float distance;
+        if (rayIntersectsSphere(rayOrigin, rayDirection, bullet.position, effectiveRadius, distance)) {
+            if (distance < closestDistance) {
+                closestDistance = distance;
+                closestBulletIndex = static_cast<int>(i);
+            }
+        }
+    }
+
+    return closestBulletIndex;
+}
+
+void GameWorld::startBulletDestroy(size_t bulletIndex) {
+    if (bulletIndex < _bullets.size()) {
+        _bullets[bulletIndex].destroying = true;
+        _bullets[bulletIndex].destroyTimer = 0.0f;
+    }
+}
+
+bool GameWorld::rayIntersectsSphere(
+    const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& sphereCenter,
+    float sphereRadius, float& distance) {
+    glm::vec3 oc = rayOrigin - sphereCenter;
+    float a = glm::dot(rayDirection, rayDirection);
+    float b = 2.0f * glm::dot(oc, rayDirection);
+    float c = glm::dot(oc, oc) - sphereRadius * sphereRadius;
+
+    float discriminant = b * b - 4 * a * c;
+    if (discriminant < 0) {
+        return false;
+    }
+
+    float t1 = (-b - sqrt(discriminant)) / (2.0f * a);
+    float t2 = (-b + sqrt(discriminant)) / (2.0f * a);
+
+    if (t1 > 0) {
+        distance = t1;
+        return true;
+    } else if (t2 > 0) {
+        distance = t2;
+        return true;
+    }
+
+    return false;
+}
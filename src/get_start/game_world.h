@@ -0,0 +1,212 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../base/event_scheduler.h"
+#include "../base/job_system.h"
+
+enum class GameState {
+    WaitingToStart,
+    Playing,
+    WaveBreak,
+    GameOver
+};
+
+inline const char* getGameStateName(GameState state) {
+    switch (state) {
+    case GameState::WaitingToStart: return "WaitingToStart";
+    case GameState::Playing: return "Playing";
+    case GameState::WaveBreak: return "WaveBreak";
+    case GameState::GameOver: return "GameOver";
+    }
+    return "Unknown";
+}
+
+struct Player {
+    glm::vec3 position{0.0f, 0.0f, 0.0f};
+    glm::vec3 previousPosition{0.0f, 0.0f, 0.0f};
+    float moveRange = 5.0f;
+    int health = 3;
+    float radius = 0.5f;
+};
+
+struct Bullet {
+    glm::vec3 position;
+    glm::vec3 previousPosition;
+    glm::vec3 velocity;
+    glm::vec3 color{1.0f, 1.0f, 1.0f};
+    float radius = 0.2f;
+    bool active = true;
+    bool destroying = false;
+    float destroyTimer = 0.0f;
+    float destroyDuration = 0.5f;
+};
+
+// launchers stand on the ground ring, their height always follows the player
+struct Launcher {
+    glm::vec3 position;
+    float fireInterval = 1.0f;
+    float lastFireTime = 0.0f;
+};
+
+struct GameParams {
+    float bulletSpeed = 2.0f;
+    int initialLaunchers = 2;
+    int launchersPerWave = 2;
+    float launcherRadius = 8.0f;
+    float fireInterval = 1.0f;
+    float waveTime = 30.0f;
+    float waveBreakTime = 5.0f;
+};
+
+// input forwarded from the render thread to the simulation
+enum class SimulationEventType {
+    StartGame,
+    ResetGame,
+    Move,
+    Fire,
+    SetParams
+};
+
+struct SimulationEvent {
+    SimulationEventType type;
+    float moveAxis = 0.0f;
+    glm::vec3 rayOrigin{0.0f};
+    glm::vec3 rayDirection{0.0f};
+    GameParams params;
+};
+
+// immutable per-tick copy of the game state consumed by the render thread
+struct BulletSnapshot {
+    glm::vec3 position;
+    glm::vec3 previousPosition;
+    glm::vec3 color;
+    float radius;
+    bool destroying;
+    float destroyProgress;
+};
+
+struct LauncherSnapshot {
+    glm::vec3 position;
+};
+
+struct SceneSnapshot {
+    std::chrono::high_resolution_clock::time_point tickTime;
+    GameState gameState = GameState::WaitingToStart;
+    float gameTime = 0.0f;
+    int currentWave = 1;
+    float waveTime = 30.0f;
+    float waveTimer = 0.0f;
+    float breakTime = 5.0f;
+    float breakTimer = 0.0f;
+    bool showStartText = true;
+    glm::vec3 playerPosition{0.0f};
+    glm::vec3 playerPreviousPosition{0.0f};
+    float playerRadius = 0.5f;
+    int playerHealth = 3;
+    std::vector<BulletSnapshot> bullets;
+    // launchers only change between waves, only copied when the version differs
+    std::vector<LauncherSnapshot> launchers;
+    uint32_t launchersVersion = 0;
+};
+
+// The game rules: waves, launchers, bullets, collisions and damage.
+// Has no GL or GLFW dependency so that it can run without a window; it only changes
+// through applyEvent() and tick(), which keeps it deterministic for replays.
+class GameWorld {
+public:
+    // bullets are updated on the job system's workers when one is given
+    explicit GameWorld(JobSystem* jobSystem = nullptr);
+
+    void applyEvent(const SimulationEvent& event);
+
+    void tick(float deltaTime);
+
+    void writeSnapshot(SceneSnapshot& snapshot) const;
+
+    // back to a fresh game with the given parameters and the tick counter at zero
+    void restart(const GameParams& params);
+
+    uint64_t computeStateHash() const;
+
+    // index of the closest live bullet hit by the ray, -1 if none
+    int pickBullet(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const;
+
+    // lets load tests keep the game going no matter how many bullets hit
+    void setInvulnerable(bool invulnerable) {
+        _invulnerable = invulnerable;
+    }
+
+    // swept test of both spheres over the last tick, fast bullets cannot tunnel through
+    static bool isPlayerHit(const Bullet& bullet, const Player& player);
+
+    uint32_t getTick() const {
+        return _tick;
+    }
+
+    GameState getGameState() const {
+        return _gameState;
+    }
+
+    const GameParams& getParams() const {
+        return _params;
+    }
+
+    size_t getBulletCount() const {
+        return _bullets.size();
+    }
+
+    size_t getLauncherCount() const {
+        return _launchers.size();
+    }
+
+private:
+    JobSystem* _jobSystem = nullptr;
+
+    GameState _gameState = GameState::WaitingToStart;
+    float _gameTime = 0.0f;
+    int _currentWave = 1;
+    float _waveTimer = 0.0f;
+    float _breakTime = 5.0f;
+    float _breakTimer = 0.0f;
+
+    // 开始界面文字闪烁
+    float _blinkTimer = 0.0f;
+    bool _showStartText = true;
+
+    Player _player;
+    std::vector<Bullet> _bullets;
+    std::vector<Launcher> _launchers;
+    EventScheduler _launcherSchedule;
+    uint32_t _launchersVersion = 1;
+    GameParams _params;
+    float _moveAxis = 0.0f;
+    bool _invulnerable = false;
+
+    uint32_t _tick = 0;
+    float _deltaTime = 0.0f;
+
+    void reset();
+    void start();
+    void updatePlayer();
+    void updateGame();
+    void updateBullets();
+    void updateLaunchers();
+    void updateWaitingState();
+    void rescheduleLaunchers();
+    void setupLaunchers(int count);
+    void spawnBullet(const Launcher& launcher);
+    void checkCollisions();
+    void takeDamage();
+    void handleWaveTransition();
+    void fireAt(const glm::vec3& rayOrigin, const glm::vec3& rayDirection);
+    void startBulletDestroy(size_t bulletIndex);
+
+    static bool rayIntersectsSphere(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& sphereCenter,
+        float sphereRadius, float& distance);
+};
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <string>
 
 #include "scene.h"
 
@@ -13,17 +15,127 @@ Options getOptions(int argc, char* argv[]) {
     options.msaa = true;
     options.glVersion = {3, 3};
     options.backgroundColor = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    options.simulationRate = 60.0f;
+    options.maxSimulationSteps = 5;
+    options.threadedSimulation = true;
     options.assetRootDir = "../../media/";
 
     return options;
 }
 
+// --record <file>              record the session's input to a file
+// --replay <file>              replay a recording at fixed dt as fast as possible
+// --no-render                  skip rendering while replaying
+// --trace <file>               write per-tick timings of a replay as csv
+// --benchmark <file>           run the scripted stress benchmark and write a json report
+// --benchmark-frames <n>       measured frames per benchmark stage (default 600)
+// --chrome-trace <file>        trace the whole session, F4 stops and writes it early
+// --hitch-budget <factor>      dump frames slower than factor x the median frame (default 2)
+// --hitch-min-ms <ms>          never treat frames faster than this as hitches (default 20)
+// --allocation-budget <n>      fail when a steady gameplay frame allocates more than n times
+//                              (needs a build with -DTRACK_ALLOCATIONS=ON, and rendered frames:
+//                              not together with --no-render)
+// --shader-cache <dir>         where linked program binaries are kept (default shader_cache)
+// --no-shader-cache            compile every shader at startup
+struct RunOptions {
+    std::string recordPath;
+    std::string replayPath;
+    std::string tracePath;
+    std::string benchmarkPath;
+    std::string chromeTracePath;
+    int benchmarkFrames = 600;
+    float hitchBudget = 2.0f;
+    float hitchMinMs = 20.0f;
+    int allocationBudget = -1;
+    std::string shaderCacheDir = "shader_cache";
+    bool render = true;
+};
+
+RunOptions getRunOptions(int argc, char* argv[]) {
+    RunOptions runOptions;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            runOptions.recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            runOptions.replayPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            runOptions.tracePath = argv[++i];
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            runOptions.benchmarkPath = argv[++i];
+        } else if (arg == "--benchmark-frames" && i + 1 < argc) {
+            runOptions.benchmarkFrames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--chrome-trace" && i + 1 < argc) {
+            runOptions.chromeTracePath = argv[++i];
+        } else if (arg == "--hitch-budget" && i + 1 < argc) {
+            runOptions.hitchBudget = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--hitch-min-ms" && i + 1 < argc) {
+            runOptions.hitchMinMs = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--allocation-budget" && i + 1 < argc) {
+            runOptions.allocationBudget = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--shader-cache" && i + 1 < argc) {
+            runOptions.shaderCacheDir = argv[++i];
+        } else if (arg == "--no-shader-cache") {
+            runOptions.shaderCacheDir.clear();
+        } else if (arg == "--no-render") {
+            runOptions.render = false;
+        } else {
+            std::cerr << "ignoring unknown argument " << arg << std::endl;
+        }
+    }
+
+    // the budget is checked per rendered frame, a replay without rendering would always pass
+    if (runOptions.allocationBudget >= 0 && !runOptions.render) {
+        std::cerr << "--allocation-budget needs rendered frames, it cannot be used with --no-render"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    return runOptions;
+}
+
 int main(int argc, char* argv[]) {
     Options options = getOptions(argc, argv);
+    RunOptions runOptions = getRunOptions(argc, argv);
 
     try {
+        // started before the scene so that asset loading is in the trace
+        if (!runOptions.chromeTracePath.empty()) {
+            Tracer::setThreadName("main");
+            Tracer::start();
+        }
+
+        // the scene links its programs in the constructor
+        GLSLProgram::setBinaryCacheDirectory(runOptions.shaderCacheDir);
+
         Scene app(options);
-        app.run();
+        app.setHitchBudget(runOptions.hitchBudget, runOptions.hitchMinMs);
+        if (runOptions.allocationBudget >= 0) {
+            app.setAllocationBudget(runOptions.allocationBudget);
+        }
+        if (!runOptions.chromeTracePath.empty()) {
+            app.setTraceOutputPath(runOptions.chromeTracePath);
+        }
+        if (!runOptions.benchmarkPath.empty()) {
+            app.benchmark(runOptions.benchmarkPath, runOptions.benchmarkFrames);
+        } else if (!runOptions.replayPath.empty()) {
+            app.replay(runOptions.replayPath, runOptions.render, runOptions.tracePath);
+        } else {
+            if (!runOptions.recordPath.empty()) {
+                app.startRecording(runOptions.recordPath);
+            }
+            app.run();
+            app.finishRecording();
+        }
+
+        if (Tracer::isEnabled() && !runOptions.chromeTracePath.empty()) {
+            Tracer::stop();
+            Tracer::writeChromeJson(runOptions.chromeTracePath);
+        }
+
+        if (app.hasExceededAllocationBudget()) {
+            exit(EXIT_FAILURE);
+        }
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         exit(EXIT_FAILURE);
@@ -3,6 +3,8 @@
 #include <cmath>
 #include <glad/gl.h>
 
+#include "../base/normal_matrix.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -22,10 +24,11 @@ void PrimitiveRenderer::init() {
         "out vec3 worldPosition;\n"
         "out vec3 normal;\n"
         "uniform mat4 model;\n"
+        "uniform mat3 normalMatrix;\n"
         "uniform mat4 view;\n"
         "uniform mat4 projection;\n"
         "void main() {\n"
-        "    normal = mat3(transpose(inverse(model))) * aNormal;\n"
+        "    normal = normalMatrix * aNormal;\n"
         "    worldPosition = vec3(model * vec4(aPosition, 1.0f));\n"
         "    gl_Position = projection * view * vec4(worldPosition, 1.0f);\n"
         "}\n";
@@ -254,6 +257,7 @@ void PrimitiveRenderer::renderMesh(const Mesh& mesh, const glm::mat4& modelMatri
     
     _shader->use();
     _shader->setUniformMat4("model", modelMatrix);
+    _shader->setUniformMat3("normalMatrix", computeNormalMatrix(modelMatrix));
     _shader->setUniformMat4("view", view);
     _shader->setUniformMat4("projection", projection);
     _shader->setUniformVec3("objectColor", color);
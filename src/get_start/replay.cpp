@@ -0,0 +1,129 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "replay.h"
+
+namespace {
+const char kMagic[4] = {'G', 'S', 'R', 'P'};
+const uint32_t kVersion = 1;
+
+// values are stored in host byte order, recordings are meant for the machine that made them
+template <typename T>
+void write(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read(std::ifstream& in) {
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("recording is truncated");
+    }
+    return value;
+}
+
+void writeParams(std::ofstream& out, const GameParams& params) {
+    write(out, params.bulletSpeed);
+    write(out, params.initialLaunchers);
+    write(out, params.launchersPerWave);
+    write(out, params.launcherRadius);
+    write(out, params.fireInterval);
+    write(out, params.waveTime);
+    write(out, params.waveBreakTime);
+}
+
+GameParams readParams(std::ifstream& in) {
+    GameParams params;
+    params.bulletSpeed = read<float>(in);
+    params.initialLaunchers = read<int>(in);
+    params.launchersPerWave = read<int>(in);
+    params.launcherRadius = read<float>(in);
+    params.fireInterval = read<float>(in);
+    params.waveTime = read<float>(in);
+    params.waveBreakTime = read<float>(in);
+    return params;
+}
+} // namespace
+
+void InputRecording::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("open " + path + " for writing failure");
+    }
+
+    out.write(kMagic, sizeof(kMagic));
+    write(out, kVersion);
+    write(out, seed);
+    write(out, simulationRate);
+    writeParams(out, params);
+    write(out, tickCount);
+    write(out, stateHash);
+
+    write(out, static_cast<uint32_t>(events.size()));
+    for (const auto& recorded : events) {
+        const SimulationEvent& event = recorded.event;
+        write(out, recorded.tick);
+        write(out, static_cast<uint8_t>(event.type));
+
+        // only the payload the event type uses
+        switch (event.type) {
+        case SimulationEventType::Move: write(out, event.moveAxis); break;
+        case SimulationEventType::Fire:
+            write(out, event.rayOrigin);
+            write(out, event.rayDirection);
+            break;
+        case SimulationEventType::SetParams: writeParams(out, event.params); break;
+        default: break;
+        }
+    }
+
+    if (!out) {
+        throw std::runtime_error("write " + path + " failure");
+    }
+}
+
+InputRecording InputRecording::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("open " + path + " failure");
+    }
+
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error(path + " is not a recording");
+    }
+
+    if (read<uint32_t>(in) != kVersion) {
+        throw std::runtime_error(path + " was recorded by an incompatible version");
+    }
+
+    InputRecording recording;
+    recording.seed = read<uint32_t>(in);
+    recording.simulationRate = read<float>(in);
+    recording.params = readParams(in);
+    recording.tickCount = read<uint32_t>(in);
+    recording.stateHash = read<uint64_t>(in);
+
+    const uint32_t eventCount = read<uint32_t>(in);
+    recording.events.reserve(eventCount);
+    for (uint32_t i = 0; i < eventCount; ++i) {
+        RecordedEvent recorded;
+        recorded.tick = read<uint32_t>(in);
+        recorded.event.type = static_cast<SimulationEventType>(read<uint8_t>(in));
+
+        switch (recorded.event.type) {
+        case SimulationEventType::Move: recorded.event.moveAxis = read<float>(in); break;
+        case SimulationEventType::Fire:
+            recorded.event.rayOrigin = read<glm::vec3>(in);
+            recorded.event.rayDirection = read<glm::vec3>(in);
+            break;
+        case SimulationEventType::SetParams: recorded.event.params = readParams(in); break;
+        default: break;
+        }
+
+        recording.events.push_back(recorded);
+    }
+
+    return recording;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game_world.h"
+
+struct RecordedEvent {
+    uint32_t tick;
+    SimulationEvent event;
+};
+
+// Everything needed to re-run a session tick for tick: the simulation only changes
+// through SimulationEvents, so those are recorded together with the tick they were
+// applied on, plus the parameters the session started with.
+struct InputRecording {
+    // the game has no random state yet, the seed is stored so that replays stay
+    // valid once it does
+    uint32_t seed = 0;
+    float simulationRate = 60.0f;
+    GameParams params;
+    std::vector<RecordedEvent> events;
+
+    // written when the recording is finished, replays compare against it
+    uint32_t tickCount = 0;
+    uint64_t stateHash = 0;
+
+    void save(const std::string& path) const;
+
+    static InputRecording load(const std::string& path);
+};
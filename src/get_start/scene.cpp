@@ -5,6 +5,7 @@
 #include <imgui_impl_opengl3.h>
 
 #include <iostream>
+#include <fstream>
 #include <cmath>
 #include <random>
 #include <algorithm>
@@ -15,11 +16,26 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include "benchmark.h"
+#include "replay.h"
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-Scene::Scene(const Options& options) : Application(options) {
+namespace {
+const uint32_t kFrameConstantsBinding = 0;
+// 几帧的文字顶点，每个字符 96 字节
+const size_t kStreamBufferSize = 1 << 20;
+
+// 包围盒所有角点到模型原点的最大距离，用作包围球半径
+float getBoundingRadius(const BoundingBox& box) {
+	return glm::length(glm::max(glm::abs(box.min), glm::abs(box.max)));
+}
+}
+
+Scene::Scene(const Options& options) : Application(options), _world(&_jobSystem) {
+	const auto startupStart = std::chrono::high_resolution_clock::now();
 	glfwSetInputMode(_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	const float aspect = 1.0f * _windowWidth / _windowHeight;
@@ -30,12 +46,14 @@ Scene::Scene(const Options& options) : Application(options) {
 	_lastMouseX = _windowWidth / 2.0f;
 	_lastMouseY = _windowHeight / 2.0f;
 
-  _textrenderer.reset(new TextRenderer());
+	_streamBuffer.reset(new StreamBuffer(kStreamBufferSize));
+  _textrenderer.reset(new TextRenderer(*_streamBuffer));
 
-	initShader();
-  initTexShader();
-	initLitTexShader();
-  _textrenderer->initshader();
+	{
+		TRACE_SCOPE("init shaders");
+		_shaderLibrary.reset(new ShaderLibrary(getAssetFullPath("shader/")));
+		initFrameConstants();
+	}
 	initGameObjects();
   initTex();
 
@@ -47,15 +65,56 @@ Scene::Scene(const Options& options) : Application(options) {
 	for (size_t i = 0; i < skyboxTextureRelPaths.size(); i++) {
 		skyboxTextureFullPaths.push_back(getAssetFullPath(skyboxTextureRelPaths[i]));
 	}
-	_skybox.reset(new SkyBox(skyboxTextureFullPaths));
+	{
+		TRACE_SCOPE("load skybox");
+		_skybox.reset(new SkyBox(skyboxTextureFullPaths));
+	}
 
   // 初始化相机初始视角
   glm::vec3 dir = glm::normalize(glm::vec3(0.0f, 0.0f, 0.0f) - _freeCameraPos);
   _yaw = glm::degrees(atan2(dir.z, dir.x));
   _pitch = glm::degrees(asin(dir.y));
 
+	// long frames dump the recent frame timings together with what was on screen
+	_hitchDetector.setJobSystem(&_jobSystem);
+	_hitchDetector.setContextProvider([this]() {
+		const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+		const GLResourceStats glResources = GLResourceRegistry::getTotalStats();
+		HitchContext context;
+		context.gameState = getGameStateName(snapshot.gameState);
+		context.values = {
+			{ "wave", snapshot.currentWave },
+			{ "game_time", snapshot.gameTime },
+			{ "bullets", static_cast<double>(snapshot.bullets.size()) },
+			{ "launchers", static_cast<double>(snapshot.launchers.size()) },
+			{ "model_draw_calls", static_cast<double>(Model::getDrawCount()) },
+			{ "culled_bullets", static_cast<double>(_culled.bullets) },
+			{ "culled_launchers", static_cast<double>(_culled.launchers) },
+			{ "culled_models", static_cast<double>(_culled.models) },
+			{ "gl_timer_queries", static_cast<double>(_profiler.getQueryCount()) },
+			{ "gl_live_objects", static_cast<double>(glResources.live) },
+			{ "gl_bytes", static_cast<double>(glResources.bytes) },
+			{ "gl_created_last_frame", static_cast<double>(glResources.created) },
+			{ "gl_deleted_last_frame", static_cast<double>(glResources.deleted) },
+		};
+		return context;
+	});
+
+	// the render thread only ever reads snapshots, make sure there is one before the first frame
+	_inspectorParams = _world.getParams();
+	publishSnapshot();
+	_snapshots.update();
+
 	// init imGUI
 	initImGui();
+
+	// 启动报告：着色器的编译/链接时间，以及有多少程序直接从二进制缓存加载
+	const GLSLProgram::ShaderSetupStats& shaderStats = GLSLProgram::getSetupStats();
+	const float startupMs = std::chrono::duration<float, std::milli>(
+		std::chrono::high_resolution_clock::now() - startupStart).count();
+	std::cout << "startup " << startupMs << " ms, shader setup " << shaderStats.ms << " ms ("
+		<< shaderStats.programs << " programs, " << shaderStats.fromBinaryCache << " from the binary cache, "
+		<< shaderStats.rejectedBinaries << " rejected)" << std::endl;
 }
 
 void Scene::initImGui()
@@ -89,6 +148,7 @@ void Scene::clearImGui()
 }
 
 void Scene::renderInspectorPanel() {
+	TRACE_SCOPE("Scene::renderInspectorPanel");
 	const auto flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings;
 
 	if (!ImGui::Begin("Scene", nullptr, flags)) {
@@ -96,13 +156,20 @@ void Scene::renderInspectorPanel() {
 		return;
 	}
 	if (ImGui::CollapsingHeader("Params", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::SliderFloat("BulletSpeed", &_bulletSpeed, 0.5f, 10.0f);
-		ImGui::SliderFloat("LauncherRadius", &_launcherRadius, 4.0f, 12.0f);
-		ImGui::SliderFloat("FireInterval", &_fireInterval, 0.2f, 5.0f);
-		ImGui::InputInt("InitialLaunchers", &_initialLaunchers);
-		ImGui::InputInt("LaunchersPerWave", &_launchersPerWave);
-		ImGui::SliderFloat("WaveTime", &_waveTime, 10.0f, 100.0f);
-		ImGui::SliderFloat("WaveBreakTime", &_waveBreakTime, 1.0f, 15.0f);
+		bool changed = false;
+		changed |= ImGui::SliderFloat("BulletSpeed", &_inspectorParams.bulletSpeed, 0.5f, 10.0f);
+		changed |= ImGui::SliderFloat("LauncherRadius", &_inspectorParams.launcherRadius, 4.0f, 12.0f);
+		changed |= ImGui::SliderFloat("FireInterval", &_inspectorParams.fireInterval, 0.2f, 5.0f);
+		changed |= ImGui::InputInt("InitialLaunchers", &_inspectorParams.initialLaunchers);
+		changed |= ImGui::InputInt("LaunchersPerWave", &_inspectorParams.launchersPerWave);
+		changed |= ImGui::SliderFloat("WaveTime", &_inspectorParams.waveTime, 10.0f, 100.0f);
+		changed |= ImGui::SliderFloat("WaveBreakTime", &_inspectorParams.waveBreakTime, 1.0f, 15.0f);
+		if (changed) {
+			SimulationEvent event;
+			event.type = SimulationEventType::SetParams;
+			event.params = _inspectorParams;
+			pushSimulationEvent(event);
+		}
 	}
 	if (ImGui::CollapsingHeader("Lighting", ImGuiTreeNodeFlags_DefaultOpen)) {
 		ImGui::SliderFloat3("LightPosition", &_lightPosition.x, -20.0f, 20.0f);
@@ -113,20 +180,14 @@ void Scene::renderInspectorPanel() {
 		ImGui::SliderFloat("Shininess", &_shininess, 1.0f, 128.0f);
 	}
 	if (ImGui::CollapsingHeader("States", ImGuiTreeNodeFlags_DefaultOpen)) {
-		std::string gameStateStr;
-		switch (_gameState) {
-			case GameState::WaitingToStart: gameStateStr = "WaitingToStart"; break;
-			case GameState::Playing: gameStateStr = "Playing"; break;
-			case GameState::WaveBreak: gameStateStr = "WaveBreak"; break;
-			case GameState::GameOver: gameStateStr = "GameOver"; break;
-		}
-		ImGui::TextColored(ImVec4(1, 1, 0, 1), std::string("GameState:").append(gameStateStr).c_str());
-		ImGui::TextColored(ImVec4(1, 1, 1, 1), "GameTime: %.2f", _gameTime);
-		ImGui::TextColored(ImVec4(0, 1, 0, 1), "CurrentWave: %d", _currentWave);
-		ImGui::TextColored(ImVec4(0, 0, 1, 1), "WaveTimer: %.2f", _waveTimer);
+		const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+		ImGui::TextColored(ImVec4(1, 1, 0, 1), std::string("GameState:").append(getGameStateName(snapshot.gameState)).c_str());
+		ImGui::TextColored(ImVec4(1, 1, 1, 1), "GameTime: %.2f", snapshot.gameTime);
+		ImGui::TextColored(ImVec4(0, 1, 0, 1), "CurrentWave: %d", snapshot.currentWave);
+		ImGui::TextColored(ImVec4(0, 0, 1, 1), "WaveTimer: %.2f", snapshot.waveTimer);
 	}
 	if (ImGui::CollapsingHeader("Controls", ImGuiTreeNodeFlags_DefaultOpen)) {
-		if (_gameState == GameState::WaitingToStart) {
+		if (_snapshots.getReadBuffer().gameState == GameState::WaitingToStart) {
 			if (_cameraControlMode) {
 				ImGui::TextColored(ImVec4(0, 1, 1, 1), "Mode: Camera Control");
 				ImGui::TextColored(ImVec4(1, 1, 1, 1), "Press TAB to switch to UI mode");
@@ -140,12 +201,154 @@ void Scene::renderInspectorPanel() {
 		ImGui::TextColored(ImVec4(1, 1, 1, 1), "Left Click: Destroy bullets");
 		ImGui::TextColored(ImVec4(1, 1, 1, 1), "Enter: Start game");
 		ImGui::TextColored(ImVec4(1, 1, 1, 1), "R: Reset game");
+		ImGui::TextColored(ImVec4(1, 1, 1, 1), "F3: Toggle profiler overlay");
+		ImGui::TextColored(ImVec4(1, 1, 1, 1), Tracer::isEnabled() ? "F4: Stop tracing" : "F4: Start tracing");
+	}
+	if (ImGui::CollapsingHeader("Profiler")) {
+		renderProfilerPanel();
 	}
 
 	ImGui::End();
 }
 
+void Scene::renderProfilerWindow() {
+	ImGui::SetNextWindowPos(ImVec2(20, 120), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.85f);
+	if (ImGui::Begin("Profiler", &_showProfiler, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings)) {
+		renderProfilerPanel();
+	}
+	ImGui::End();
+}
+
+void Scene::renderProfilerPanel() {
+	// gpu times arrive Profiler::kFrameLatency frames late, so this shows a slightly old frame
+	const std::vector<Profiler::Sample>& frame = _profiler.getLastFrame();
+	const float frameMs = std::max(_profiler.getLastFrameCpuMs(), 0.001f);
+	ImGui::Text("cpu frame %.2f ms", frameMs);
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+	ImGui::Text("culled: %u/%zu bullets, %u/%zu launchers, %u other models", _culled.bullets,
+		snapshot.bullets.size(), _culled.launchers, snapshot.launchers.size(), _culled.models);
+	const bool showAllocations = AllocationTracker::isEnabled();
+	if (showAllocations) {
+		const AllocationCounts& frameAllocations = _profiler.getLastFrameAllocations();
+		ImGui::Text("render thread: %llu allocations, %.1f KB per frame",
+			static_cast<unsigned long long>(frameAllocations.allocations), frameAllocations.bytes / 1024.0f);
+	}
+
+	// timeline: one row per nesting depth, bars placed by cpu start time
+	const float width = 480.0f;
+	const float rowHeight = 18.0f;
+	int maxDepth = 0;
+	for (const auto& sample : frame) {
+		maxDepth = std::max(maxDepth, sample.depth);
+	}
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + rowHeight * (maxDepth + 1)), IM_COL32(30, 30, 30, 255));
+	for (size_t i = 0; i < frame.size(); ++i) {
+		const Profiler::Sample& sample = frame[i];
+		const float x0 = origin.x + width * sample.cpuStartMs / frameMs;
+		const float x1 = std::max(x0 + 1.0f, origin.x + width * (sample.cpuStartMs + sample.cpuMs) / frameMs);
+		const float y0 = origin.y + rowHeight * sample.depth;
+		const ImU32 color = ImColor::HSV((i * 0.13f) - static_cast<int>(i * 0.13f), 0.6f, 0.8f);
+		drawList->AddRectFilled(ImVec2(x0, y0 + 1.0f), ImVec2(x1, y0 + rowHeight - 1.0f), color);
+		drawList->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y0 + rowHeight), true);
+		drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), sample.name);
+		drawList->PopClipRect();
+	}
+	ImGui::Dummy(ImVec2(width, rowHeight * (maxDepth + 1)));
+
+	ImGui::Columns(showAllocations ? 5 : 3, "passes", false);
+	ImGui::Text("pass"); ImGui::NextColumn();
+	ImGui::Text("cpu ms"); ImGui::NextColumn();
+	ImGui::Text("gpu ms"); ImGui::NextColumn();
+	if (showAllocations) {
+		ImGui::Text("allocs"); ImGui::NextColumn();
+		ImGui::Text("KB"); ImGui::NextColumn();
+	}
+	for (const auto& sample : frame) {
+		ImGui::Text("%*s%s", 2 * sample.depth, "", sample.name); ImGui::NextColumn();
+		ImGui::Text("%.3f", sample.cpuMs); ImGui::NextColumn();
+		if (sample.gpuMs >= 0.0f) {
+			ImGui::Text("%.3f", sample.gpuMs);
+		} else {
+			ImGui::TextDisabled("-");
+		}
+		ImGui::NextColumn();
+		if (showAllocations) {
+			ImGui::Text("%llu", static_cast<unsigned long long>(sample.allocations.allocations)); ImGui::NextColumn();
+			ImGui::Text("%.1f", sample.allocations.bytes / 1024.0f); ImGui::NextColumn();
+		}
+	}
+	ImGui::Columns(1);
+
+	// gl calls per pass, "calls/redundant" when some of them changed nothing
+	if (GLCallStats::isEnabled()) {
+		auto showCount = [](const GLCallCounts& counts, GLCallCategory category) {
+			if (counts.getRedundant(category) > 0) {
+				ImGui::Text("%llu/%llu", static_cast<unsigned long long>(counts.getCalls(category)),
+					static_cast<unsigned long long>(counts.getRedundant(category)));
+			} else {
+				ImGui::Text("%llu", static_cast<unsigned long long>(counts.getCalls(category)));
+			}
+			ImGui::NextColumn();
+		};
+		auto showCounts = [&showCount](const char* name, int depth, const GLCallCounts& counts) {
+			ImGui::Text("%*s%s", 2 * depth, "", name); ImGui::NextColumn();
+			for (int i = 0; i < kGLCallCategoryCount; ++i) {
+				showCount(counts, static_cast<GLCallCategory>(i));
+			}
+			ImGui::Text("%.1f", counts.uploadBytes / 1024.0); ImGui::NextColumn();
+		};
+
+		ImGui::Separator();
+		ImGui::Columns(kGLCallCategoryCount + 2, "gl calls", false);
+		ImGui::Text("gl calls"); ImGui::NextColumn();
+		for (int i = 0; i < kGLCallCategoryCount; ++i) {
+			ImGui::Text("%s", GLCallStats::getCategoryName(static_cast<GLCallCategory>(i))); ImGui::NextColumn();
+		}
+		ImGui::Text("upload KB"); ImGui::NextColumn();
+		showCounts("frame", 0, _profiler.getLastFrameGLCalls());
+		for (const auto& sample : frame) {
+			showCounts(sample.name, sample.depth + 1, sample.glCalls);
+		}
+		ImGui::Columns(1);
+	}
+
+	// gl objects of the base wrappers, created/deleted count the previous frame
+	ImGui::Separator();
+	ImGui::Columns(5, "gl resources", false);
+	ImGui::Text("gl object"); ImGui::NextColumn();
+	ImGui::Text("live"); ImGui::NextColumn();
+	ImGui::Text("KB"); ImGui::NextColumn();
+	ImGui::Text("created"); ImGui::NextColumn();
+	ImGui::Text("deleted"); ImGui::NextColumn();
+	for (int i = 0; i <= static_cast<int>(GLResourceType::Count); ++i) {
+		const GLResourceType type = static_cast<GLResourceType>(i);
+		const bool total = type == GLResourceType::Count;
+		const GLResourceStats stats = total ? GLResourceRegistry::getTotalStats() : GLResourceRegistry::getStats(type);
+		ImGui::Text("%s", total ? "total" : GLResourceRegistry::getTypeName(type)); ImGui::NextColumn();
+		ImGui::Text("%u", stats.live); ImGui::NextColumn();
+		ImGui::Text("%.1f", stats.bytes / 1024.0); ImGui::NextColumn();
+		ImGui::Text("%u", stats.created); ImGui::NextColumn();
+		ImGui::Text("%u", stats.deleted); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	// rolling history, cpu and gpu per scope
+	const int offset = _profiler.getHistoryOffset();
+	for (const auto& entry : _profiler.getHistories()) {
+		const Profiler::History& history = entry.second;
+		const std::string cpuLabel = entry.first + " cpu";
+		const std::string gpuLabel = entry.first + " gpu";
+		ImGui::PlotLines(cpuLabel.c_str(), history.cpuMs.data(), Profiler::kHistorySize, offset, nullptr, 0.0f, FLT_MAX, ImVec2(width * 0.5f, 30.0f));
+		ImGui::SameLine();
+		ImGui::PlotLines(gpuLabel.c_str(), history.gpuMs.data(), Profiler::kHistorySize, offset, nullptr, 0.0f, FLT_MAX, ImVec2(width * 0.5f, 30.0f));
+	}
+}
+
 void Scene::renderUI() {
+	ProfileScope scope(_profiler, "imgui inspector");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -156,11 +359,13 @@ void Scene::renderUI() {
 }
 
 void Scene::renderGameUI() {
+	ProfileScope scope(_profiler, "imgui hud");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 	
 	ImGuiIO& io = ImGui::GetIO();
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
 	
 	// Health display in top-left corner
 	ImGui::SetNextWindowPos(ImVec2(20, 20));
@@ -180,7 +385,7 @@ void Scene::renderGameUI() {
 	ImGui::SameLine();
 	
 	for (int i = 0; i < 3; ++i) {
-		if (i < _player.health) {
+		if (i < snapshot.playerHealth) {
 			ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "[#]");
 		} else {
 			ImGui::TextColored(ImVec4(0.3f, 0.3f, 0.3f, 1.0f), "[ ]");
@@ -201,11 +406,11 @@ void Scene::renderGameUI() {
 		ImGuiWindowFlags_AlwaysAutoResize);
 	
 	ImGui::SetWindowFontScale(1.8f);
-	ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Wave %d", _currentWave);
+	ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Wave %d", snapshot.currentWave);
 	ImGui::End();
 	
 	// Countdown timer in top-right corner
-	float timeRemaining = _waveTime - _waveTimer;
+	float timeRemaining = snapshot.waveTime - snapshot.waveTimer;
 	ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - 180, 20));
 	ImGui::SetNextWindowBgAlpha(0.8f);
 	ImGui::Begin("Timer", nullptr, 
@@ -225,7 +430,7 @@ void Scene::renderGameUI() {
 	ImGui::End();
 	
 	// Game Over screen
-	if (_gameState == GameState::GameOver) {
+	if (snapshot.gameState == GameState::GameOver) {
 		ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f - 200, io.DisplaySize.y * 0.5f - 120));
 		ImGui::SetNextWindowBgAlpha(0.9f);
 		ImGui::Begin("GameOver", nullptr, 
@@ -240,22 +445,28 @@ void Scene::renderGameUI() {
 		ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "GAME OVER");
     
 		ImGui::SetWindowFontScale(1.4f);
-		ImGui::TextColored(ImVec4(1.0f, 1.0f, 1.0f, 1.0f), "Survived %d waves", _currentWave - 1);
+		ImGui::TextColored(ImVec4(1.0f, 1.0f, 1.0f, 1.0f), "Survived %d waves", snapshot.currentWave - 1);
 		ImGui::TextColored(ImVec4(1.0f, 1.0f, 1.0f, 1.0f), "Press R to restart");
     _textrenderer->renderText("GAME OVER", 800.0f, 540.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
 		ImGui::End();
 	}
+
+	if (_showProfiler) {
+		renderProfilerWindow();
+	}
 	
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
 void Scene::renderWaveBreakUI() {
+	ProfileScope scope(_profiler, "imgui wave break");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 	
 	ImGuiIO& io = ImGui::GetIO();
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
 	
 	// 休息提示
 	ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x * 0.5f - 200, io.DisplaySize.y * 0.5f - 100));
@@ -269,12 +480,12 @@ void Scene::renderWaveBreakUI() {
 		ImGuiWindowFlags_AlwaysAutoResize);
 	
 	ImGui::SetWindowFontScale(2.5f);
-	ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "Wave %d Complete!", _currentWave);
+	ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "Wave %d Complete!", snapshot.currentWave);
 	
 	ImGui::SetWindowFontScale(1.8f);
-	ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Preparing Wave %d...", _currentWave + 1);
+	ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Preparing Wave %d...", snapshot.currentWave + 1);
 	
-	float timeRemaining = _breakTime - _breakTimer;
+	float timeRemaining = snapshot.breakTime - snapshot.breakTimer;
 	ImGui::SetWindowFontScale(2.0f);
 	if (timeRemaining <= 3.0f) {
 		ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%.1f", timeRemaining);
@@ -283,6 +494,10 @@ void Scene::renderWaveBreakUI() {
 	}
 	
 	ImGui::End();
+
+	if (_showProfiler) {
+		renderProfilerWindow();
+	}
 	
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -292,200 +507,100 @@ Scene::~Scene() {
 	clearImGui();
 }
 
-void Scene::initShader() {
-	const char* vsCode =
-		"#version 330 core\n"
-		"layout(location = 0) in vec3 aPosition;\n"
-		"layout(location = 1) in vec3 aNormal;\n"
-
-		"out vec3 worldPosition;\n"
-		"out vec3 normal;\n"
-
-		"uniform mat4 model;\n"
-		"uniform mat4 view;\n"
-		"uniform mat4 projection;\n"
-
-		"void main() {\n"
-		"    normal = mat3(transpose(inverse(model))) * aNormal;\n"
-		"    worldPosition = vec3(model * vec4(aPosition, 1.0f));\n"
-		"    gl_Position = projection * view * vec4(worldPosition, 1.0f);\n"
-		"}\n";
-
-	const char* fsCode =
-		"#version 330 core\n"
-		"in vec3 worldPosition;\n"
-		"in vec3 normal;\n"
-		"out vec4 fragColor;\n"
-
-		"uniform vec3 objectColor;\n"
-		"uniform vec3 lightPos;\n"
-		"uniform vec3 lightColor;\n"
-		"uniform vec3 viewPos;\n"
-		"uniform float lightIntensity;\n"
-		"uniform float ambientStrength;\n"
-		"uniform float specularStrength;\n"
-		"uniform float shininess;\n"
-
-		"void main() {\n"
-		"    vec3 normalizedNormal = normalize(normal);\n"
-		"    \n"
-		"    // Ambient lighting\n"
-		"    vec3 ambient = ambientStrength * lightColor;\n"
-		"    \n"
-		"    // Diffuse lighting\n"
-		"    vec3 lightDir = normalize(lightPos - worldPosition);\n"
-		"    float diff = max(dot(normalizedNormal, lightDir), 0.0);\n"
-		"    vec3 diffuse = diff * lightColor;\n"
-		"    \n"
-		"    // Specular lighting\n"
-		"    vec3 viewDir = normalize(viewPos - worldPosition);\n"
-		"    vec3 reflectDir = reflect(-lightDir, normalizedNormal);\n"
-		"    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);\n"
-		"    vec3 specular = specularStrength * spec * lightColor;\n"
-		"    \n"
-		"    // Combine results\n"
-		"    vec3 result = (ambient + diffuse + specular) * lightIntensity * objectColor;\n"
-		"    fragColor = vec4(result, 1.0);\n"
-		"}\n";
-
-	_shader.reset(new GLSLProgram);
-	_shader->attachVertexShader(vsCode);
-	_shader->attachFragmentShader(fsCode);
-	_shader->link();
-}
+void Scene::initFrameConstants() {
+	// std140 gives the block the same layout in every program, one of them is enough to reflect it;
+	// the other variants bind it in getObjectProgram()
+	const GLSLProgram& program = *getObjectProgram(ShaderFeatureLit).program;
+	const int blockSize = program.getUniformBlockSize("FrameConstants");
+	if (blockSize <= 0) {
+		throw std::runtime_error("cannot find the FrameConstants uniform block");
+	}
 
-void Scene::initTexShader(){
-    const char* vsCode =
-      "#version 330 core\n"
-      "layout(location = 0) in vec3 aPosition;\n"
-      "layout(location = 1) in vec3 aNormal;\n"
-      "layout(location = 2) in vec2 aTexCoord;\n"
-      "out vec2 fTexCoord;\n"
-      "uniform mat4 projection;\n"
-      "uniform mat4 view;\n"
-      "uniform mat4 model;\n"
-
-      "void main() {\n"
-      "    fTexCoord = aTexCoord;\n"
-      "    gl_Position = projection * view * model * vec4(aPosition, 1.0f);\n"
-      "}\n";
-
-    const char* fsCode =
-      "#version 330 core\n"
-      "in vec2 fTexCoord;\n"
-      "out vec4 color;\n"
-      "uniform sampler2D mapKd;\n"
-      "void main() {\n"
-      "    color = texture(mapKd, fTexCoord);\n"
-      "}\n";
-
-    _texshader.reset(new GLSLProgram);
-    _texshader->attachVertexShader(vsCode);
-    _texshader->attachFragmentShader(fsCode);
-    _texshader->link();
+	_frameConstants.reset(new UniformBuffer(blockSize, GL_DYNAMIC_DRAW));
+	_frameConstants->reflectOffsets(program, { "projection", "view", "viewPos", "lightPos", "lightColor", "lightIntensity" });
+	_frameConstants->setBindingPoint(kFrameConstantsBinding);
 }
 
-void Scene::initLitTexShader() {
-    const char* vsCode =
-      "#version 330 core\n"
-      "layout(location = 0) in vec3 aPosition;\n"
-      "layout(location = 1) in vec3 aNormal;\n"
-      "layout(location = 2) in vec2 aTexCoord;\n"
-      
-      "out vec3 worldPosition;\n"
-      "out vec3 normal;\n"
-      "out vec2 fTexCoord;\n"
-      
-      "uniform mat4 model;\n"
-      "uniform mat4 view;\n"
-      "uniform mat4 projection;\n"
-
-      "void main() {\n"
-      "    normal = mat3(transpose(inverse(model))) * aNormal;\n"
-      "    worldPosition = vec3(model * vec4(aPosition, 1.0f));\n"
-      "    fTexCoord = aTexCoord;\n"
-      "    gl_Position = projection * view * vec4(worldPosition, 1.0f);\n"
-      "}\n";
-
-    const char* fsCode =
-      "#version 330 core\n"
-      "in vec3 worldPosition;\n"
-      "in vec3 normal;\n"
-      "in vec2 fTexCoord;\n"
-      "out vec4 fragColor;\n"
-      
-      "uniform sampler2D mapKd;\n"
-      "uniform vec3 lightPos;\n"
-      "uniform vec3 lightColor;\n"
-      "uniform vec3 viewPos;\n"
-      "uniform float lightIntensity;\n"
-      "uniform float ambientStrength;\n"
-      "uniform float specularStrength;\n"
-      "uniform float shininess;\n"
-
-      "void main() {\n"
-      "    vec3 normalizedNormal = normalize(normal);\n"
-      "    \n"
-      "    // Sample texture color\n"
-      "    vec3 textureColor = texture(mapKd, fTexCoord).rgb;\n"
-      "    \n"
-      "    // Ambient lighting\n"
-      "    vec3 ambient = ambientStrength * lightColor;\n"
-      "    \n"
-      "    // Diffuse lighting\n"
-      "    vec3 lightDir = normalize(lightPos - worldPosition);\n"
-      "    float diff = max(dot(normalizedNormal, lightDir), 0.0);\n"
-      "    vec3 diffuse = diff * lightColor;\n"
-      "    \n"
-      "    // Specular lighting\n"
-      "    vec3 viewDir = normalize(viewPos - worldPosition);\n"
-      "    vec3 reflectDir = reflect(-lightDir, normalizedNormal);\n"
-      "    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);\n"
-      "    vec3 specular = specularStrength * spec * lightColor;\n"
-      "    \n"
-      "    // Combine results with texture\n"
-      "    vec3 result = (ambient + diffuse + specular) * lightIntensity * textureColor;\n"
-      "    fragColor = vec4(result, 1.0);\n"
-      "}\n";
-
-    _litTexShader.reset(new GLSLProgram);
-    _litTexShader->attachVertexShader(vsCode);
-    _litTexShader->attachFragmentShader(fsCode);
-    _litTexShader->link();
+const Scene::ObjectProgram& Scene::getObjectProgram(uint32_t features) {
+	auto iter = _objectPrograms.find(features);
+	if (iter != _objectPrograms.end()) {
+		return iter->second;
+	}
+
+	// 首次使用时才编译这个变体，只取它实际用到的uniform，避免查找被优化掉的名字时报错
+	GLSLProgram& program = _shaderLibrary->getVariant("object.vert", "object.frag", features);
+	program.setUniformBlockBinding("FrameConstants", kFrameConstantsBinding);
+	ObjectProgram& entry = _objectPrograms[features];
+	entry.program = &program;
+	if (!(features & ShaderFeatureInstanced)) {
+		entry.uniforms.model = program.getUniformHandle<glm::mat4>("model");
+		if (features & ShaderFeatureLit) {
+			entry.uniforms.normalMatrix = program.getUniformHandle<glm::mat3>("normalMatrix");
+		}
+	}
+	if (!(features & ShaderFeatureTextured)) {
+		entry.uniforms.objectColor = program.getUniformHandle<glm::vec3>("objectColor");
+	}
+	if (features & ShaderFeatureLit) {
+		entry.uniforms.ambientStrength = program.getUniformHandle<float>("ambientStrength");
+		entry.uniforms.specularStrength = program.getUniformHandle<float>("specularStrength");
+		entry.uniforms.shininess = program.getUniformHandle<float>("shininess");
+	}
+	if (features & ShaderFeatureMorph) {
+		entry.uniforms.morphWeight = program.getUniformHandle<float>("morphWeight");
+	}
+	return entry;
 }
 
 void Scene::initGameObjects() {
+	TRACE_SCOPE("Scene::initGameObjects");
+	// 模型在工作线程上导入，这里只做GL上传
+	JobSystem::JobHandle sphereJob = loadModelAsync(_sphereModel, "obj/sphere.obj");
+	JobSystem::JobHandle cylinderJob = loadModelAsync(_cylinderModel, "obj/cylinder.obj");
+	JobSystem::JobHandle turretJob0 = loadModelAsync(_turretModel[0], "obj/turret01.obj");
+	JobSystem::JobHandle turretJob1 = loadModelAsync(_turretModel[1], "obj/turret02.obj");
+	std::cout << "loading: " + getAssetFullPath("obj/colt_SAA_(OBJ).obj") << std::endl;
+	JobSystem::JobHandle gunJob = loadModelAsync(_gunModel, "obj/colt_SAA_(OBJ).obj");
+	JobSystem::JobHandle flashJob = loadModelAsync(_flashModel, "obj/muzzle_flash.obj");
+
+	_jobSystem.waitOnMainThread(_jobSystem.schedule([]() {},
+		{ sphereJob, cylinderJob, turretJob0, turretJob1, gunJob, flashJob }));
+
 	try {
-		_sphereModel.reset(new Model(getAssetFullPath("obj/sphere.obj")));
+		_jobSystem.wait(sphereJob);
 	}
 	catch (...) {
 		std::cout << "Warning: sphere.obj not found, using basic rendering" << std::endl;
 	}
 
 	try {
-		_cylinderModel.reset(new Model(getAssetFullPath("obj/cylinder.obj")));
+		_jobSystem.wait(cylinderJob);
 	}
 	catch (...) {
 		std::cout << "Warning: cylinder.obj not found, using basic rendering" << std::endl;
 	}
 
 	try {
-		_turretModel[0].reset(new Model(getAssetFullPath("obj/turret01.obj")));
+		_jobSystem.wait(turretJob0);
     _turretModel[0]->transform.scale = glm::vec3(6.0f, 1.5f, 1.5f);
 	}
 	catch (...) {
 		std::cout << "Warning: turret.obj not found, using basic rendering" << std::endl;
 	}
   try {
-		_turretModel[1].reset(new Model(getAssetFullPath("obj/turret02.obj")));
+		_jobSystem.wait(turretJob1);
     _turretModel[1]->transform.scale = glm::vec3(6.0f, 1.5f, 1.5f);
+		// 两个关键帧之间的插值交给顶点着色器（MORPH），不再每帧在CPU上重建炮台模型
+		if (_turretModel[0]) {
+			_turretModel[0]->setMorphTarget(*_turretModel[1]);
+			_turretMorphReady = true;
+		}
 	}
 	catch (...) {
 		std::cout << "Warning: turret02.obj not found, using basic rendering" << std::endl;
 	}
 	try {
-		std::cout << "loading: " + getAssetFullPath("obj/colt_SAA_(OBJ).obj") << std::endl;
-		_gunModel.reset(new Model(getAssetFullPath("obj/colt_SAA_(OBJ).obj")));
+		_jobSystem.wait(gunJob);
     _gunModel->transform.scale = glm::vec3(1.0f, 1.0f, 1.0f);
 	}
 	catch (...) {
@@ -493,20 +608,16 @@ void Scene::initGameObjects() {
 	}
 
 	try {
-		_flashModel.reset(new Model(getAssetFullPath("obj/muzzle_flash.obj")));
+		_jobSystem.wait(flashJob);
 	_flashModel->transform.scale = glm::vec3(1.0f, 1.0f, 1.0f);
 	}
 	catch (...) {
 		std::cout << "Warning: muzzle_flash.obj not found, using basic rendering" << std::endl;
 	}
-
-	_player.position = glm::vec3(0.0f, 0.0f, 0.0f);
-	_player.health = 3;
-
-	setupLaunchers(_initialLaunchers);
 }
 
 void Scene::initTex() {
+	TRACE_SCOPE("Scene::initTex");
 	const std::string turretTextureRelPath = "texture/turret/T_2K__albedo.png";
 	const std::string gunTextureBaseRelPath = "texture/gun/colt_saa_BaseColor.png";
 	const std::vector<std::string> flashTextureRelPaths = {
@@ -516,41 +627,62 @@ void Scene::initTex() {
 		"texture/flash/muzzle_flash_05.png"
 	};
 
-	std::shared_ptr<Texture2D> gunTextureBase = std::make_shared<ImageTexture2D>(getAssetFullPath(gunTextureBaseRelPath));
-	std::shared_ptr<Texture2D> turretTexture = std::make_shared<ImageTexture2D>(getAssetFullPath(turretTextureRelPath));
-	_turrettex = turretTexture;
-	_guntexbase = gunTextureBase;
+	// 图片在工作线程上解码，这里只做GL上传
+	std::vector<JobSystem::JobHandle> jobs;
+	jobs.push_back(loadTextureAsync(_guntexbase, gunTextureBaseRelPath));
+	jobs.push_back(loadTextureAsync(_turrettex, turretTextureRelPath));
 	_flashtexs.clear();
-	for (auto flashTextureRelPath : flashTextureRelPaths) {
-		std::shared_ptr<Texture2D> flashTexture = std::make_shared<ImageTexture2D>(getAssetFullPath(flashTextureRelPath));
-		_flashtexs.push_back(flashTexture);
+	_flashtexs.resize(flashTextureRelPaths.size());
+	for (size_t i = 0; i < flashTextureRelPaths.size(); ++i) {
+		jobs.push_back(loadTextureAsync(_flashtexs[i], flashTextureRelPaths[i]));
 	}
-}
 
-void Scene::setupLaunchers(int count) {
-	//std::cout << "Setting up " << count << " launchers" << std::endl;
-	_launchers.clear();
-	
-	for (int i = 0; i < count; ++i) {
-		Launcher launcher;
-		float angle = (2.0f * M_PI * i) / count;
-		launcher.position = glm::vec3(
-			_launcherRadius * cos(angle),
-			0.0f,
-			_launcherRadius * sin(angle)
-		);
-		launcher.targetPosition = _player.position;
-		launcher.fireInterval = _fireInterval; 
-		
-		// 错开发射，但保持相同的发射频率
-		float timeOffset = (_fireInterval * i) / count;
-		launcher.lastFireTime = _gameTime - _fireInterval + timeOffset;
-		
-		_launchers.push_back(launcher);
+	// wait for every upload before rethrowing a failure, the jobs write into our members
+	_jobSystem.waitOnMainThread(_jobSystem.schedule([]() {}, jobs));
+	for (const auto& job : jobs) {
+		_jobSystem.wait(job);
 	}
 }
 
+JobSystem::JobHandle Scene::loadModelAsync(std::unique_ptr<Model>& model, const std::string& relPath) {
+	const std::string path = getAssetFullPath(relPath);
+	const char* importName = Tracer::intern("import " + relPath);
+	const char* uploadName = Tracer::intern("upload " + relPath);
+	auto vertices = std::make_shared<std::vector<Vertex>>();
+	auto indices = std::make_shared<std::vector<uint32_t>>();
+	JobSystem::JobHandle importJob = _jobSystem.schedule([path, importName, vertices, indices]() {
+		TRACE_SCOPE(importName);
+		Model::importMesh(path, *vertices, *indices);
+	});
+	// 上传任务的句柄同时带着导入和上传的失败
+	return _jobSystem.runOnMainThread([this, &model, importJob, vertices, indices, uploadName]() {
+		_jobSystem.wait(importJob);
+		TRACE_SCOPE(uploadName);
+		model.reset(new Model(*vertices, *indices));
+	}, { importJob });
+}
+
+JobSystem::JobHandle Scene::loadTextureAsync(std::shared_ptr<Texture2D>& texture, const std::string& relPath) {
+	const std::string path = getAssetFullPath(relPath);
+	const char* decodeName = Tracer::intern("decode " + relPath);
+	const char* uploadName = Tracer::intern("upload " + relPath);
+	auto image = std::make_shared<DecodedImage>();
+	JobSystem::JobHandle decodeJob = _jobSystem.schedule([path, decodeName, image]() {
+		TRACE_SCOPE(decodeName);
+		*image = ImageTexture2D::decode(path);
+	});
+	return _jobSystem.runOnMainThread([this, &texture, decodeJob, image, path, uploadName]() {
+		_jobSystem.wait(decodeJob);
+		TRACE_SCOPE(uploadName);
+		texture = std::make_shared<ImageTexture2D>(*image, path);
+	}, { decodeJob });
+}
+
 void Scene::handleInput() {
+	// pick up the latest tick, the rest of the frame reads game state from it
+	_snapshots.update();
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+
 	if (_input.keyboard.keyStates[GLFW_KEY_ESCAPE] != GLFW_RELEASE) {
 		glfwSetWindowShouldClose(_window, true);
 		return;
@@ -558,7 +690,35 @@ void Scene::handleInput() {
   if (_input.keyboard.keyStates[GLFW_KEY_F2] == GLFW_PRESS) {
 			saveScreenshot();
 	}
-	if (_gameState == GameState::WaitingToStart) {
+	bool currentF3Pressed = (_input.keyboard.keyStates[GLFW_KEY_F3] == GLFW_PRESS);
+	if (currentF3Pressed && !_prevF3Pressed) {
+		_showProfiler = !_showProfiler;
+	}
+	_prevF3Pressed = currentF3Pressed;
+	bool currentF4Pressed = (_input.keyboard.keyStates[GLFW_KEY_F4] == GLFW_PRESS);
+	if (currentF4Pressed && !_prevF4Pressed) {
+		toggleTracing();
+	}
+	_prevF4Pressed = currentF4Pressed;
+
+	float moveAxis = 0.0f;
+	if (_input.keyboard.keyStates[GLFW_KEY_W] != GLFW_RELEASE ||
+		_input.keyboard.keyStates[GLFW_KEY_UP] != GLFW_RELEASE) {
+		moveAxis += 1.0f;
+	}
+	if (_input.keyboard.keyStates[GLFW_KEY_S] != GLFW_RELEASE ||
+		_input.keyboard.keyStates[GLFW_KEY_DOWN] != GLFW_RELEASE) {
+		moveAxis -= 1.0f;
+	}
+	if (moveAxis != _sentMoveAxis) {
+		SimulationEvent event;
+		event.type = SimulationEventType::Move;
+		event.moveAxis = moveAxis;
+		pushSimulationEvent(event);
+		_sentMoveAxis = moveAxis;
+	}
+
+	if (snapshot.gameState == GameState::WaitingToStart) {
 		bool currentTabPressed = (_input.keyboard.keyStates[GLFW_KEY_TAB] == GLFW_PRESS);
 		if (currentTabPressed && !_prevTabPressed) {
 			toggleMouseMode();
@@ -576,8 +736,7 @@ void Scene::handleInput() {
 			startGame();
 		}
 	}
-	else if (_gameState == GameState::Playing) {
-		updatePlayer();
+	else if (snapshot.gameState == GameState::Playing) {
 		handleMouseCamera();
 
 		bool currentMouseLeftPressed = _input.mouse.press.left;
@@ -585,12 +744,13 @@ void Scene::handleInput() {
 			handleMouseClick();
 		}
 		_prevMouseLeftPressed = currentMouseLeftPressed;
+		updateGun();
 
 		if (_input.keyboard.keyStates[GLFW_KEY_R] == GLFW_PRESS) {
 			resetGame();
 		}
 	}
-	else if (_gameState == GameState::WaveBreak) {
+	else if (snapshot.gameState == GameState::WaveBreak) {
 		// 休息期间允许相机控制
 		handleMouseCamera();
 		
@@ -598,33 +758,298 @@ void Scene::handleInput() {
 			resetGame();
 		}
 	}
-	else if (_gameState == GameState::GameOver) {
+	else if (snapshot.gameState == GameState::GameOver) {
 		if (_input.keyboard.keyStates[GLFW_KEY_R] == GLFW_PRESS) {
 			resetGame();
 		}
 	}
 
 	_input.forwardState();
-	updateGame();
 }
 
-void Scene::updatePlayer() {
-	float moveSpeed = 5.0f;
-	if(_gameState == GameState::Playing) {
-	if (_input.keyboard.keyStates[GLFW_KEY_W] != GLFW_RELEASE ||
-		_input.keyboard.keyStates[GLFW_KEY_UP] != GLFW_RELEASE) {
-		_player.position.y += moveSpeed * _deltaTime;
-		_player.position.y = std::min(_player.position.y, _player.moveRange);
+// runs on the simulation thread when Options::threadedSimulation is set: it may only touch
+// the game state and must talk to the render thread through events and snapshots
+void Scene::updateSimulation() {
+	SimulationEvent event;
+	while (_simulationEvents.tryPop(event)) {
+		if (_recording) {
+			_recording->events.push_back({ _world.getTick(), event });
+		}
+		_world.applyEvent(event);
 	}
 
-	if (_input.keyboard.keyStates[GLFW_KEY_S] != GLFW_RELEASE ||
-		_input.keyboard.keyStates[GLFW_KEY_DOWN] != GLFW_RELEASE) {
-		_player.position.y -= moveSpeed * _deltaTime;
-		_player.position.y = std::max(_player.position.y, -_player.moveRange);
+	_world.tick(_fixedDeltaTime);
+	publishSnapshot();
+}
+
+void Scene::startRecording(const std::string& path) {
+	_recording.reset(new InputRecording);
+	_recording->simulationRate = 1.0f / _fixedDeltaTime;
+	_recording->params = _world.getParams();
+	_recordingPath = path;
+
+	// the recording starts from a freshly reset game at tick 0
+	_world.restart(_recording->params);
+	publishSnapshot();
+}
+
+void Scene::finishRecording() {
+	if (!_recording) return;
+
+	_recording->tickCount = _world.getTick();
+	_recording->stateHash = _world.computeStateHash();
+	_recording->save(_recordingPath);
+	std::cout << "recorded " << _recording->tickCount << " ticks to " << _recordingPath
+		<< ", state hash " << std::hex << _recording->stateHash << std::dec << std::endl;
+	_recording.reset();
+}
+
+void Scene::replay(const std::string& path, bool render, const std::string& tracePath) {
+	const InputRecording recording = InputRecording::load(path);
+
+	// the simulation runs on this thread, back to back
+	_threadedSimulation = false;
+	_fixedDeltaTime = 1.0f / recording.simulationRate;
+	_world.restart(recording.params);
+	_inspectorParams = recording.params;
+
+	if (render) {
+		glfwSwapInterval(0);
+	} else {
+		glfwHideWindow(_window);
+	}
+
+	std::vector<float> simulationTimes;
+	std::vector<float> renderTimes;
+	simulationTimes.reserve(recording.tickCount);
+	renderTimes.reserve(recording.tickCount);
+
+	size_t nextEvent = 0;
+	const auto replayStart = std::chrono::high_resolution_clock::now();
+	for (uint32_t tick = 0; tick < recording.tickCount; ++tick) {
+		while (nextEvent < recording.events.size() && recording.events[nextEvent].tick == tick) {
+			pushSimulationEvent(recording.events[nextEvent++].event);
+		}
+
+		const auto tickStart = std::chrono::high_resolution_clock::now();
+		updateSimulation();
+		const auto simulationEnd = std::chrono::high_resolution_clock::now();
+
+		if (render) {
+			_snapshots.update();
+			_interpolationAlpha = 1.0f;
+			renderFrame();
+			glfwSwapBuffers(_window);
+			glfwPollEvents();
+		}
+		const auto renderEnd = std::chrono::high_resolution_clock::now();
+
+		simulationTimes.push_back(std::chrono::duration<float, std::milli>(simulationEnd - tickStart).count());
+		renderTimes.push_back(std::chrono::duration<float, std::milli>(renderEnd - simulationEnd).count());
+	}
+	const float totalTime = std::chrono::duration<float>(
+		std::chrono::high_resolution_clock::now() - replayStart).count();
+
+	const uint64_t stateHash = _world.computeStateHash();
+	std::cout << "replayed " << recording.tickCount << " ticks in " << totalTime << " s ("
+		<< recording.tickCount / totalTime << " ticks/s), state hash " << std::hex << stateHash
+		<< (stateHash == recording.stateHash ? " matches" : " DIFFERS from") << " the recording "
+		<< recording.stateHash << std::dec << std::endl;
+
+	if (!tracePath.empty()) {
+		std::ofstream trace(tracePath);
+		if (!trace) {
+			throw std::runtime_error("open " + tracePath + " for writing failure");
+		}
+		trace << "tick,simulation_ms,render_ms\n";
+		for (size_t i = 0; i < simulationTimes.size(); ++i) {
+			trace << i << ',' << simulationTimes[i] << ',' << renderTimes[i] << '\n';
+		}
 	}
+}
+
+void Scene::benchmark(const std::string& reportPath, int framesPerStage) {
+	// one tick per frame at fixed dt, so that every build simulates and draws the same frames
+	_threadedSimulation = false;
+	glfwSwapInterval(0);
+
+	// the untimed warm-up between stages would look like a hitch
+	_hitchDetector.setRateLimit(0.0f, 0);
+
+	// gpu times are read back a few frames late so that the queries never stall the pipeline
+	const int queryLatency = 4;
+	const bool timeGpu = GLAD_GL_VERSION_3_3 != 0;
+	GLuint gpuQueries[queryLatency] = {};
+	if (timeGpu) {
+		glGenQueries(queryLatency, gpuQueries);
+	}
+	auto readGpuTime = [&gpuQueries](int frame) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(gpuQueries[frame % queryLatency], GL_QUERY_RESULT, &elapsed);
+		return static_cast<float>(elapsed) * 1.0e-6f;
+	};
+	// the profiler's pass queries would nest inside the frame query, which GL does not allow
+	_profiler.setGpuTimingEnabled(!timeGpu);
+
+	std::vector<BenchmarkStageResult> results;
+	for (const BenchmarkStage& stage : getDefaultBenchmarkStages()) {
+		if (glfwWindowShouldClose(_window)) {
+			break;
+		}
+
+		// the interval that keeps about targetBullets alive: a bullet lives from the launcher
+		// ring until it is 20 units past the player
+		GameParams params;
+		params.initialLaunchers = stage.launchers;
+		const float lifetime = (params.launcherRadius + 20.0f) / params.bulletSpeed;
+		params.fireInterval = stage.launchers * lifetime / stage.targetBullets;
+		params.waveTime = 1.0e9f;
+
+		_world.restart(params);
+		_world.setInvulnerable(true);
+		_inspectorParams = params;
+
+		SimulationEvent start;
+		start.type = SimulationEventType::StartGame;
+		pushSimulationEvent(start);
+
+		// fill the arena before measuring, nothing is drawn meanwhile
+		const int warmupTicks = static_cast<int>(lifetime / _fixedDeltaTime) + 1;
+		for (int i = 0; i < warmupTicks; ++i) {
+			updateSimulation();
+		}
+
+		BenchmarkStageResult result;
+		result.stage = stage;
+		for (int frame = 0; frame < framesPerStage; ++frame) {
+			const auto frameStart = std::chrono::high_resolution_clock::now();
+			updateSimulation();
+			_snapshots.update();
+			const auto simulationEnd = std::chrono::high_resolution_clock::now();
+
+			// fixed camera path: one full turn around the player per stage
+			const float yaw = glm::radians(-90.0f + 360.0f * frame / framesPerStage);
+			const glm::vec3 eye = _snapshots.getReadBuffer().playerPosition + glm::vec3(0.0f, 1.0f, 0.0f);
+			_camera->transform.position = eye;
+			_camera->transform.lookAt(eye + glm::vec3(cos(yaw), 0.0f, sin(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			if (timeGpu) {
+				if (frame >= queryLatency) {
+					result.gpuTimes.push_back(readGpuTime(frame - queryLatency));
+				}
+				glBeginQuery(GL_TIME_ELAPSED, gpuQueries[frame % queryLatency]);
+			}
+			_interpolationAlpha = 1.0f;
+			const GLCallCounts glCallsBefore = GLCallStats::getCounts();
+			renderFrame();
+			if (timeGpu) {
+				glEndQuery(GL_TIME_ELAPSED);
+			}
+			result.glCalls += GLCallStats::getCounts() - glCallsBefore;
+			const auto renderEnd = std::chrono::high_resolution_clock::now();
+
+			glfwSwapBuffers(_window);
+			glfwPollEvents();
+			const auto swapEnd = std::chrono::high_resolution_clock::now();
+
+			result.frameTimes.push_back(std::chrono::duration<float, std::milli>(swapEnd - frameStart).count());
+			result.simulationTimes.push_back(std::chrono::duration<float, std::milli>(simulationEnd - frameStart).count());
+			result.renderTimes.push_back(std::chrono::duration<float, std::milli>(renderEnd - simulationEnd).count());
+			result.swapTimes.push_back(std::chrono::duration<float, std::milli>(swapEnd - renderEnd).count());
+			result.bulletCounts.push_back(static_cast<float>(_world.getBulletCount()));
+		}
+
+		if (timeGpu) {
+			for (int frame = std::max(0, framesPerStage - queryLatency); frame < framesPerStage; ++frame) {
+				result.gpuTimes.push_back(readGpuTime(frame));
+			}
+		}
+
+		const FrameTimeStats frameStats = computeFrameTimeStats(result.frameTimes);
+		std::cout << stage.launchers << " launchers, " << _world.getBulletCount() << " bullets: p50 "
+			<< frameStats.p50 << " ms, p99 " << frameStats.p99 << " ms" << std::endl;
+
+		results.push_back(std::move(result));
+	}
+
+	if (timeGpu) {
+		glDeleteQueries(queryLatency, gpuQueries);
+	}
+	_profiler.setGpuTimingEnabled(true);
+
+	UniformOverheadResult uniformOverhead;
+	if (!glfwWindowShouldClose(_window)) {
+		uniformOverhead = measureUniformOverhead(20000);
+		std::cout << "uniforms per bullet draw: glGetUniformLocation " << uniformOverhead.locationLookupNs
+			<< " ns, by name " << uniformOverhead.nameLookupNs << " ns, handles " << uniformOverhead.handleNs << " ns" << std::endl;
+	}
+
+	writeBenchmarkReport(reportPath, 1.0f / _fixedDeltaTime, results, uniformOverhead);
+}
+
+UniformOverheadResult Scene::measureUniformOverhead(int draws) {
+	// the bullet loop without the simulation: only the model matrix changes between draws
+	const glm::vec3 color(1.0f);
+	const ObjectProgram& lit = getObjectProgram(ShaderFeatureLit);
+	GLSLProgram& shader = *lit.program;
+	const ObjectUniforms& uniforms = lit.uniforms;
+	auto measure = [this, draws](auto setUniforms) {
+		glFinish();
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < draws; ++i) {
+			setUniforms(glm::translate(glm::mat4(1.0f), glm::vec3(0.001f * i, 0.0f, 0.0f)));
+			_sphereModel->draw();
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+		glFinish();
+		return std::chrono::duration<float, std::nano>(end - start).count() / draws;
+	};
+
+	auto setByHandle = [&shader, &uniforms, &color](const glm::mat4& model) {
+		shader.setUniform(uniforms.model, model);
+		shader.setUniform(uniforms.objectColor, color);
+		shader.setUniform(uniforms.specularStrength, 0.4f);
+		shader.setUniform(uniforms.shininess, 32.0f);
+	};
+	auto setByName = [&shader, &color](const glm::mat4& model) {
+		shader.setUniformMat4("model", model);
+		shader.setUniformVec3("objectColor", color);
+		shader.setUniformFloat("specularStrength", 0.4f);
+		shader.setUniformFloat("shininess", 32.0f);
+	};
+	// what every setter did before the uniforms were reflected at link time
+	const GLuint program = shader.getHandle();
+	auto setByLocation = [program, &color](const glm::mat4& model) {
+		glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+		glUniform3fv(glGetUniformLocation(program, "objectColor"), 1, glm::value_ptr(color));
+		glUniform1f(glGetUniformLocation(program, "specularStrength"), 0.4f);
+		glUniform1f(glGetUniformLocation(program, "shininess"), 32.0f);
+	};
+
+	shader.use();
+	UniformOverheadResult result;
+	result.draws = draws;
+	measure(setByHandle);
+	result.handleNs = measure(setByHandle);
+	result.nameLookupNs = measure(setByName);
+	// runs last: it bypasses the program's value cache, but leaves the same values behind
+	result.locationLookupNs = measure(setByLocation);
+	return result;
+}
+
+void Scene::pushSimulationEvent(const SimulationEvent& event) {
+	if (!_simulationEvents.tryPush(event)) {
+		std::cerr << "simulation event queue is full, input dropped" << std::endl;
 	}
 }
 
+void Scene::publishSnapshot() {
+	SceneSnapshot& snapshot = _snapshots.getWriteBuffer();
+	snapshot.tickTime = std::chrono::high_resolution_clock::now();
+	_world.writeSnapshot(snapshot);
+	_snapshots.publish();
+}
+
 void Scene::handleCameraInput() {
 	const float orbitSpeed = 1.0f;
 	const float zoomSpeed = 5.0f;
@@ -658,134 +1083,142 @@ void Scene::updateCamera() {
 	float x = _cameraDistance * cos(_cameraAngle);
 	float z = _cameraDistance * sin(_cameraAngle);
 	_camera->transform.position = glm::vec3(x, 5.0f, z);
-	_camera->transform.lookAt(_player.position, glm::vec3(0.0f, 1.0f, 0.0f));
+	_camera->transform.lookAt(_snapshots.getReadBuffer().playerPosition, glm::vec3(0.0f, 1.0f, 0.0f));
 }
 
 void Scene::renderFrame() {
+	TRACE_SCOPE("Scene::renderFrame");
+	_profiler.beginFrame();
+	_hitchDetector.addFrame(_profiler);
+	if (_allocationBudget >= 0) {
+		checkAllocationBudget();
+	}
 	showFpsInWindowTitle();
+	Model::resetDrawCount();
+	GLResourceRegistry::beginFrame();
 
 	glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+	// 每个渲染通道结束时都恢复默认状态，这里深度写入一定是打开的
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glEnable(GL_DEPTH_TEST);
+
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+	if (_threadedSimulation) {
+		// the snapshot is one tick ahead of what we show, blend towards it as time passes
+		const float sinceTick = std::chrono::duration<float>(
+			std::chrono::high_resolution_clock::now() - snapshot.tickTime).count();
+		_renderAlpha = glm::clamp(sinceTick / _fixedDeltaTime, 0.0f, 1.0f);
+	} else {
+		_renderAlpha = _interpolationAlpha;
+	}
+
+	// the first person camera follows the interpolated player, not the last tick
+	if (snapshot.gameState == GameState::Playing || snapshot.gameState == GameState::WaveBreak) {
+		_camera->transform.position = interpolate(snapshot.playerPreviousPosition, snapshot.playerPosition) + glm::vec3(0.0f, 1.0f, 0.0f);
+	}
 
 	glm::mat4 projection = _camera->getProjectionMatrix();
 	glm::mat4 view = _camera->getViewMatrix();
 
-	_texshader->use();
-	_texshader->setUniformMat4("projection", projection);
-	_texshader->setUniformMat4("view", view);
+	// 相机没有变化时不必再比较相机相关的常量
+	if (_camera->getVersion() != _frameConstantsCameraVersion) {
+		_frameConstants->update("projection", projection);
+		_frameConstants->update("view", view);
+		_frameConstants->update("viewPos", _camera->transform.position);
+		_frameConstantsCameraVersion = _camera->getVersion();
+	}
+	_frameConstants->update("lightPos", _lightPosition);
+	_frameConstants->update("lightColor", _lightColor);
+	_frameConstants->update("lightIntensity", _lightIntensity);
+	_frameConstants->upload();
 	
-	if (_gameState == GameState::WaitingToStart) {
-		renderPlayer();
-		renderLaunchers();
-		renderLightIndicator();
-		_skybox->draw(projection, view);
-
-		if (_cameraControlMode) {
-			renderStartScreen();
-		} else {
-			renderUI();
+	// 不透明物体按状态排序、由近到远绘制，天空盒之后再由远到近绘制透明物体
+	buildRenderQueue(snapshot.gameState, view);
+	auto setUniforms = [this](const GLSLProgram& program, uint32_t index) {
+		applyDrawParams(program, index);
+	};
+	{
+		ProfileScope scope(_profiler, "opaque");
+		ScopedRenderPass pass(_glState, RenderPass::Opaque);
+		_renderQueue.submit(RenderPass::Opaque, _glState, setUniforms);
+	}
+	renderSkybox(projection, view);
+	{
+		ProfileScope scope(_profiler, "transparent");
+		ScopedRenderPass pass(_glState, RenderPass::Transparent);
+		_renderQueue.submit(RenderPass::Transparent, _glState, setUniforms);
+	}
+
+	// 文字和面板：关闭深度测试、开启混合，只在这个通道内有效
+	{
+		ScopedRenderPass pass(_glState, RenderPass::UI);
+		if (snapshot.gameState == GameState::WaitingToStart) {
+			if (_cameraControlMode) {
+				renderStartScreen();
+			} else {
+				renderUI();
+			}
+		}
+		else if (snapshot.gameState == GameState::Playing) {
+			renderGameUI();
+			renderCrosshair();
+		}
+		else if (snapshot.gameState == GameState::WaveBreak) {
+			renderWaveBreakUI();
+		}
+		else if (snapshot.gameState == GameState::GameOver) {
+			renderGameUI();
 		}
 	}
-	else if (_gameState == GameState::Playing) {
-		renderPlayer();
-		renderBullets();
-		renderLaunchers();
-		renderLightIndicator();
-		_skybox->draw(projection, view);
-		renderGun();
-		renderMuzzleFlash();
-		renderGameUI();
-		renderCrosshair();
-	}
-	else if (_gameState == GameState::WaveBreak) {
-		renderPlayer();
-		renderBullets(); // 渲染剩余子弹
-		renderLaunchers();
-		renderLightIndicator();
-		_skybox->draw(projection, view);
-		renderGun();
-		renderMuzzleFlash();
-		renderWaveBreakUI();
-	}
-	else if (_gameState == GameState::GameOver) {
-		renderPlayer();
-		renderBullets();
-		renderLaunchers();
-		renderLightIndicator();
-		_skybox->draw(projection, view);
-		renderGun();
-		renderMuzzleFlash();
-		renderGameUI();
-	}
-	
-}
 
-void Scene::updateGame() {
-	if(_gameState == GameState::Playing) {
-		_gameTime += _deltaTime;
-		_waveTimer += _deltaTime;
+	TRACE_COUNTER("bullets", static_cast<double>(snapshot.bullets.size()));
+	TRACE_COUNTER("model draw calls", static_cast<double>(Model::getDrawCount()));
+	TRACE_COUNTER("culled objects", static_cast<double>(_culled.bullets + _culled.launchers + _culled.models));
+	TRACE_COUNTER("gl objects created", static_cast<double>(GLResourceRegistry::getTotalStats().created));
+	TRACE_COUNTER("stream buffer stalls", static_cast<double>(_streamBuffer->getStallCount()));
+	_streamBuffer->endFrame();
+	_profiler.endFrame();
+}
 
-		updateBullets();
-		updateLaunchers();
-		checkCollisions();
-		updateGun();
-		handleWaveTransition();
-	}
-	else if (_gameState == GameState::WaitingToStart) {
-		updateWaitingState();
-	}
-	else if (_gameState == GameState::WaveBreak) {
-		_breakTimer += _deltaTime;
-		updateBullets(); 
-		
-		// 休息时间结束后开始下一波
-		if (_breakTimer >= _breakTime) {
-			_currentWave++;
-			_waveTimer = 0.0f;
-			_gameState = GameState::Playing;
-			
-			int newLauncherCount = _initialLaunchers + (_currentWave - 1) * _launchersPerWave;
-			setupLaunchers(newLauncherCount);
-		}
+void Scene::setAllocationBudget(int allocationsPerFrame) {
+	if (!AllocationTracker::isEnabled()) {
+		throw std::runtime_error("an allocation budget needs a build configured with -DTRACK_ALLOCATIONS=ON");
 	}
+	_allocationBudget = allocationsPerFrame;
 }
 
-void Scene::updateBullets() {
-	for (auto& bullet : _bullets) {
-		if (!bullet.active) continue;
+void Scene::checkAllocationBudget() {
+	// only steady gameplay is held to the budget, loading and state changes may allocate
+	const int warmupFrames = 120;
+	if (_snapshots.getReadBuffer().gameState != GameState::Playing) {
+		_steadyFrames = 0;
+		return;
+	}
+	if (++_steadyFrames <= warmupFrames || _profiler.getLastFrame().empty()) {
+		return;
+	}
 
-		if (bullet.destroying) {
-			bullet.destroyTimer += _deltaTime;
-			if (bullet.destroyTimer >= bullet.destroyDuration) {
-				bullet.active = false;
-			}
-		} else {
-			bullet.position += bullet.velocity * _deltaTime;
+	const AllocationCounts& allocations = _profiler.getLastFrameAllocations();
+	if (allocations.allocations <= static_cast<uint64_t>(_allocationBudget) || _allocationBudgetExceeded) {
+		return;
+	}
 
-			float distanceFromCenter = glm::length(bullet.position);
-			if (distanceFromCenter > 20.0f) {
-				bullet.active = false;
-			}
+	_allocationBudgetExceeded = true;
+	std::cerr << "frame " << _profiler.getLastFrameIndex() << " made " << allocations.allocations
+		<< " allocations (" << allocations.bytes << " bytes), the budget is " << _allocationBudget << '\n';
+	for (const auto& sample : _profiler.getLastFrame()) {
+		if (sample.allocations.allocations > 0) {
+			std::cerr << std::string(2 * sample.depth + 2, ' ') << sample.name << ": "
+				<< sample.allocations.allocations << " allocations, " << sample.allocations.bytes << " bytes\n";
 		}
 	}
-
-	_bullets.erase(std::remove_if(_bullets.begin(), _bullets.end(),
-		[](const Bullet& b) { return !b.active; }), _bullets.end());
+	std::cerr << std::flush;
+	glfwSetWindowShouldClose(_window, true);
 }
 
-void Scene::updateLaunchers() {
-	for (auto& launcher : _launchers) {
-		// 动态更新发射间隔
-		launcher.fireInterval = _fireInterval;
-		
-		if (_gameTime - launcher.lastFireTime >= launcher.fireInterval) {
-			launcher.targetPosition = _player.position;
-			spawnBullet(launcher);
-			launcher.lastFireTime = _gameTime;
-		}
-		launcher.position = glm::vec3(launcher.position.x, _player.position.y, launcher.position.z);
-	}
+void Scene::renderSkybox(const glm::mat4& projection, const glm::mat4& view) {
+	ProfileScope scope(_profiler, "skybox");
+	ScopedRenderPass pass(_glState, RenderPass::Skybox);
+	_skybox->draw(projection, view);
 }
 
 void Scene::updateGun() {
@@ -829,158 +1262,138 @@ void Scene::updateGun() {
     }
 }
 
-void Scene::spawnBullet(const Launcher& launcher) {
-	Bullet bullet;
-	bullet.position = launcher.position;
-
-	glm::vec3 direction = glm::normalize(launcher.targetPosition - launcher.position);
-	bullet.velocity = direction * _bulletSpeed;
-	bullet.color = glm::vec3(1.0f, 0.8f, 0.2f);
-	bullet.active = true;
-
-	_bullets.push_back(std::move(bullet));
-}
-
-void Scene::checkCollisions() {
-	for (const auto& bullet : _bullets) {
-		if (!bullet.active) continue;
-
-		if (!bullet.destroying && isPlayerHit(bullet)) {
-			takeDamage();
-			break;
-		}
-	}
+glm::vec3 Scene::interpolate(const glm::vec3& previous, const glm::vec3& current) const {
+	return glm::mix(previous, current, _renderAlpha);
 }
 
-bool Scene::isPlayerHit(const Bullet& bullet) const {
-	if (abs(bullet.position.y - _player.position.y) > (_player.radius + bullet.radius)) {
-		return false;
-	}
-
-	float distance = glm::length(bullet.position - _player.position);
-	return distance < (_player.radius + bullet.radius);
+void Scene::buildRenderQueue(GameState gameState, const glm::mat4& view) {
+	ProfileScope scope(_profiler, "build queue", false);
+	_renderQueue.clear();
+	_drawModels.clear();
+	_drawParams.clear();
+	_frustum = _camera->getFrustum();
+	_culled = CullingCounts();
+
+	queuePlayer(view);
+	if (gameState != GameState::WaitingToStart) {
+		queueBullets(view);
+	}
+	queueLaunchers(view);
+	queueLightIndicator(view);
+	if (gameState != GameState::WaitingToStart) {
+		queueGun(view);
+		queueMuzzleFlash(view);
+	}
+
+	// 法线矩阵在CPU上每个物体算一次，不再在顶点着色器里逐顶点求逆
+	_drawNormalMatrices.resize(_drawModels.size());
+	computeNormalMatrices(_drawModels.data(), _drawNormalMatrices.data(), _drawModels.size());
+	_renderQueue.sort();
 }
 
-void Scene::takeDamage() {
-	_player.health--;
-	if (_player.health <= 0) {
-		_gameState = GameState::GameOver;
-	}
-
-	// 让所有活跃子弹开始销毁动画，而不是直接清空
-	for (auto& bullet : _bullets) {
-		if (bullet.active && !bullet.destroying) {
-			bullet.destroying = true;
-			bullet.destroyTimer = 0.0f;
-		}
-	}
+void Scene::queueDraw(RenderPass pass, const ObjectProgram& program, const Texture2D* texture,
+	const Model& mesh, const glm::mat4& model, const DrawParams& params, const glm::mat4& view) {
+	// 用物体原点在相机前方的距离排序
+	const float viewDepth = -(view * model[3]).z;
+	_renderQueue.push(pass, *program.program, texture ? texture->getHandle() : 0, mesh, viewDepth,
+		static_cast<uint32_t>(_drawParams.size()));
+	_drawModels.push_back(model);
+	_drawParams.push_back(params);
+	_drawParams.back().uniforms = &program.uniforms;
 }
 
-void Scene::handleWaveTransition() {
-	if (_waveTimer >= _waveTime) {
-		_gameState = GameState::WaveBreak;
-		_breakTimer = 0.0f;
-		_breakTime = _waveBreakTime; 
-		
-		// 让所有活跃子弹开始销毁动画，而不是直接清空
-		for (auto& bullet : _bullets) {
-			if (bullet.active && !bullet.destroying) {
-				bullet.destroying = true;
-				bullet.destroyTimer = 0.0f;
-			}
-		}
-	}
+void Scene::applyDrawParams(const GLSLProgram& program, uint32_t index) const {
+	const DrawParams& params = _drawParams[index];
+	const ObjectUniforms& uniforms = *params.uniforms;
+	program.setUniform(uniforms.model, _drawModels[index]);
+	program.setUniform(uniforms.normalMatrix, _drawNormalMatrices[index]);
+	program.setUniform(uniforms.objectColor, params.color);
+	program.setUniform(uniforms.ambientStrength, params.ambientStrength);
+	program.setUniform(uniforms.specularStrength, params.specularStrength);
+	program.setUniform(uniforms.shininess, params.shininess);
+	program.setUniform(uniforms.morphWeight, params.morphWeight);
 }
 
-void Scene::renderPlayer() {
-	_shader->use();
-	_shader->setUniformMat4("projection", _camera->getProjectionMatrix());
-	_shader->setUniformMat4("view", _camera->getViewMatrix());
-	_shader->setUniformVec3("lightPos", _lightPosition);
-	_shader->setUniformVec3("lightColor", _lightColor);
-	_shader->setUniformVec3("viewPos", _camera->transform.position);
-	_shader->setUniformFloat("lightIntensity", _lightIntensity);
-	_shader->setUniformFloat("ambientStrength", _ambientStrength);
-	
+void Scene::queuePlayer(const glm::mat4& view) {
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
 	glm::mat4 model = glm::mat4(1.0f);
-	model = glm::translate(model, _player.position);
-	model = glm::scale(model, glm::vec3(_player.radius));
-	_shader->setUniformMat4("model", model);
+	DrawParams params;
+	model = glm::translate(model, interpolate(snapshot.playerPreviousPosition, snapshot.playerPosition));
+	model = glm::scale(model, glm::vec3(snapshot.playerRadius));
+	params.ambientStrength = _ambientStrength;
 
-	if (_gameState == GameState::Playing || _gameState == GameState::WaveBreak) {
-		_shader->setUniformVec3("objectColor", glm::vec3(0.2f, 0.8f, 0.2f));
+	if (snapshot.gameState == GameState::Playing || snapshot.gameState == GameState::WaveBreak) {
+		params.color = glm::vec3(0.2f, 0.8f, 0.2f);
 		// 玩家使用金属材质
-		_shader->setUniformFloat("specularStrength", 0.8f);
-		_shader->setUniformFloat("shininess", 64.0f);
+		params.specularStrength = 0.8f;
+		params.shininess = 64.0f;
 	}
 	else {
-		_shader->setUniformVec3("objectColor", glm::vec3(0.8f, 0.2f, 0.2f));
-		_shader->setUniformFloat("specularStrength", 0.3f);
-		_shader->setUniformFloat("shininess", 16.0f);
+		params.color = glm::vec3(0.8f, 0.2f, 0.2f);
+		params.specularStrength = 0.3f;
+		params.shininess = 16.0f;
 	}
 
-	if (_sphereModel) {
-		_sphereModel->draw();
+	if (!_sphereModel) { return; }
+	if (!_frustum.intersect(_sphereModel->getBoundingBox(), model)) {
+		++_culled.models;
+		return;
 	}
+	queueDraw(RenderPass::Opaque, getObjectProgram(ShaderFeatureLit), nullptr, *_sphereModel, model, params, view);
 }
 
-void Scene::renderBullets() {
-	_shader->use();
-	_shader->setUniformMat4("projection", _camera->getProjectionMatrix());
-	_shader->setUniformMat4("view", _camera->getViewMatrix());
-	_shader->setUniformVec3("lightPos", _lightPosition);
-	_shader->setUniformVec3("lightColor", _lightColor);
-	_shader->setUniformVec3("viewPos", _camera->transform.position);
-	_shader->setUniformFloat("lightIntensity", _lightIntensity);
-	_shader->setUniformFloat("ambientStrength", _ambientStrength);
-	
-	for (const auto& bullet : _bullets) {
-		if (!bullet.active) continue;
+void Scene::queueBullets(const glm::mat4& view) {
+	if (!_sphereModel) { return; }
 
+	auto getScale = [](const BulletSnapshot& bullet) {
+		return bullet.destroying ? bullet.radius * (1.0f + bullet.destroyProgress * 0.5f) : bullet.radius;
+	};
+
+	// 先批量剔除视锥体外的子弹，再只为可见的子弹入队
+	const std::vector<BulletSnapshot>& bullets = _snapshots.getReadBuffer().bullets;
+	const float sphereRadius = getBoundingRadius(_sphereModel->getBoundingBox());
+	_bulletBounds.clear();
+	for (const auto& bullet : bullets) {
+		_bulletBounds.add(interpolate(bullet.previousPosition, bullet.position), getScale(bullet) * sphereRadius);
+	}
+	_culled.bullets = static_cast<uint32_t>(cullSpheres(_frustum, _bulletBounds, _visible));
+
+	for (size_t i = 0; i < bullets.size(); ++i) {
+		if (!_visible[i]) { continue; }
+		const auto& bullet = bullets[i];
 		glm::mat4 model = glm::mat4(1.0f);
-		model = glm::translate(model, bullet.position);
+		DrawParams params;
+		model = glm::translate(model, interpolate(bullet.previousPosition, bullet.position));
+		params.ambientStrength = _ambientStrength;
 		
 		if (bullet.destroying) {
-			float progress = bullet.destroyTimer / bullet.destroyDuration;
-			float scale = bullet.radius * (1.0f + progress * 0.5f);
-			model = glm::scale(model, glm::vec3(scale));
+			float progress = bullet.destroyProgress;
+			model = glm::scale(model, glm::vec3(getScale(bullet)));
 			
-			glm::vec3 destroyColor = glm::mix(bullet.color, glm::vec3(1.0f, 0.0f, 0.0f), progress);
-			_shader->setUniformVec3("objectColor", destroyColor);
+			params.color = glm::mix(bullet.color, glm::vec3(1.0f, 0.0f, 0.0f), progress);
 			// 销毁时高亮发光
-			_shader->setUniformFloat("specularStrength", 1.0f + progress);
-			_shader->setUniformFloat("shininess", 128.0f);
+			params.specularStrength = 1.0f + progress;
+			params.shininess = 128.0f;
 		} else {
 			model = glm::scale(model, glm::vec3(bullet.radius));
-			_shader->setUniformVec3("objectColor", bullet.color);
+			params.color = bullet.color;
 			// 子弹有轻微的镜面反射
-			_shader->setUniformFloat("specularStrength", 0.4f);
-			_shader->setUniformFloat("shininess", 32.0f);
+			params.specularStrength = 0.4f;
+			params.shininess = 32.0f;
 		}
 
-		_shader->setUniformMat4("model", model);
-
-		if (_sphereModel) {
-			_sphereModel->draw();
-		}
+		queueDraw(RenderPass::Opaque, getObjectProgram(ShaderFeatureLit), nullptr, *_sphereModel, model, params, view);
 	}
 }
 
-void Scene::renderLaunchers() {
-	// 使用带光照的纹理着色器
-	_litTexShader->use();
-	_litTexShader->setUniformMat4("projection", _camera->getProjectionMatrix());
-	_litTexShader->setUniformMat4("view", _camera->getViewMatrix());
-	_litTexShader->setUniformVec3("lightPos", _lightPosition);
-	_litTexShader->setUniformVec3("lightColor", _lightColor);
-	_litTexShader->setUniformVec3("viewPos", _camera->transform.position);
-	_litTexShader->setUniformFloat("lightIntensity", _lightIntensity);
-	_litTexShader->setUniformFloat("ambientStrength", _ambientStrength);
-	_litTexShader->setUniformFloat("specularStrength", _specularStrength);
-	_litTexShader->setUniformFloat("shininess", _shininess);
-	
-	for (const auto& launcher : _launchers) {
-        glm::vec3 dir = glm::normalize(_player.position - launcher.position);
+void Scene::queueLaunchers(const glm::mat4& view) {
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+	const glm::vec3 playerPosition = interpolate(snapshot.playerPreviousPosition, snapshot.playerPosition);
+	_launcherTransforms.clear();
+	_launcherTimes.clear();
+	for (const auto& launcher : snapshot.launchers) {
+        const glm::vec3 launcherPosition(launcher.position.x, playerPosition.y, launcher.position.z);
+        glm::vec3 dir = glm::normalize(playerPosition - launcherPosition);
         glm::vec3 up = glm::vec3(0, 1, 0);
         glm::vec3 right = glm::normalize(glm::cross(up, dir));
         glm::vec3 realUp = glm::cross(dir, right);
@@ -991,7 +1404,7 @@ void Scene::renderLaunchers() {
         rotation[2] = glm::vec4(dir, 0.0f);
 
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, launcher.position-glm::vec3(0.0f, 1.2f, 0.0f));
+        model = glm::translate(model, launcherPosition-glm::vec3(0.0f, 1.2f, 0.0f));
 		    model = glm::scale(model, glm::vec3(1.0f, 1.0f, 0.8f));
 		    model *= rotation;
         model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1, 0, 0));
@@ -1010,31 +1423,36 @@ void Scene::renderLaunchers() {
           time = 0.0f;
           forward = true;
         }
-        if (_turretModel[0]) {
-            _litTexShader->setUniformMat4("model", model);
-            _turrettex->bind();
-            Model currentmodel = _turretModel[0]->interpolateModel(
-                *_turretModel[0], *_turretModel[1], 
-                time
-            );
-	        currentmodel.draw();
-	    }
+        _launcherTransforms.push_back(model);
+        _launcherTimes.push_back(time);
 	}
-}
 
-void Scene::renderGun() {
-	_litTexShader->use();
-	_litTexShader->setUniformVec3("lightPos", _lightPosition);
-	_litTexShader->setUniformVec3("lightColor", _lightColor);
-	_litTexShader->setUniformVec3("viewPos", _camera->transform.position);
-	_litTexShader->setUniformFloat("lightIntensity", _lightIntensity);
-	_litTexShader->setUniformFloat("ambientStrength", _ambientStrength);
-	_litTexShader->setUniformFloat("specularStrength", _specularStrength);
-	_litTexShader->setUniformFloat("shininess", _shininess);
-		
-	glm::mat4 projection = _camera->getProjectionMatrix();
-    glm::mat4 view = glm::mat4(1.0f);
+	if (!_turretModel[0]) { return; }
+
+	// 两个关键帧包围盒的并集包住插值后的炮台
+	BoundingBox turretBox = _turretModel[0]->getBoundingBox();
+	if (_turretMorphReady) {
+		turretBox += _turretModel[1]->getBoundingBox();
+	}
+	_launcherBounds.clear();
+	for (const auto& model : _launcherTransforms) {
+		_launcherBounds.add(turretBox, model);
+	}
+	_culled.launchers = static_cast<uint32_t>(cullBoxes(_frustum, _launcherBounds, _visible));
+
+	// 两个关键帧在顶点着色器里按各自的时间混合，所有炮台共用同一个模型
+	const uint32_t features = ShaderFeatureLit | ShaderFeatureTextured
+		| (_turretMorphReady ? uint32_t(ShaderFeatureMorph) : 0u);
+	const ObjectProgram& program = getObjectProgram(features);
+	for (size_t i = 0; i < _launcherTransforms.size(); ++i) {
+		if (!_visible[i]) { continue; }
+		DrawParams params{ glm::vec3(1.0f), _ambientStrength, _specularStrength, _shininess };
+		params.morphWeight = _launcherTimes[i];
+		queueDraw(RenderPass::Opaque, program, _turrettex.get(), *_turretModel[0], _launcherTransforms[i], params, view);
+	}
+}
 
+void Scene::queueGun(const glm::mat4& view) {
 	glm::vec3 defaultDir(0.0f, 0.0f, -1.0f);
 	glm::vec3 gunDir = glm::normalize(_gun.direction);
 
@@ -1047,73 +1465,52 @@ void Scene::renderGun() {
         rotation = glm::rotate(glm::mat4(1.0f), rotationAngle, glm::normalize(rotationAxis));
     }
 
-    glm::mat4 model = glm::mat4(1.0f);
+    // 枪固定在相机空间，乘上相机矩阵的逆变换到世界空间，与其他物体共用帧常量
+    glm::mat4 model = glm::inverse(view);
     model = glm::translate(model, _gun.position);
 	model = model * rotation;
     model = glm::scale(model, glm::vec3(2.5f));
 
     if (_gunModel) {
-		_litTexShader->setUniformMat4("projection", projection);
-		_litTexShader->setUniformMat4("view", view);
-		_litTexShader->setUniformMat4("model", model);
-		_guntexbase->bind(0);
-        _gunModel->draw();
+		DrawParams params{ glm::vec3(1.0f), _ambientStrength, _specularStrength, _shininess };
+		queueDraw(RenderPass::Opaque, getObjectProgram(ShaderFeatureLit | ShaderFeatureTextured), _guntexbase.get(), *_gunModel, model, params, view);
     }
 }
 
-void Scene::renderMuzzleFlash() {
+void Scene::queueMuzzleFlash(const glm::mat4& view) {
 	if (!_isFlashing) { return; }
-	_texshader->use();
-    glm::mat4 view = glm::mat4(1.0f);
-	glm::mat4 projection = _camera->getProjectionMatrix();
-	glm::mat4 model = glm::mat4(1.0f);
+	glm::mat4 model = glm::inverse(view);
 	model = glm::translate(model, _muzzleFlash.position);
 	model = glm::scale(model, glm::vec3(0.8f));
 
 	if (_flashModel) {
-	_texshader->setUniformMat4("projection", projection);
-	_texshader->setUniformMat4("view", view); 
-		_texshader->setUniformMat4("model", model);
-		_flashtexs[_currentFlashtex]->bind();
-		_flashModel->draw();
+		DrawParams params{ glm::vec3(1.0f), 1.0f, 0.0f, 1.0f };
+		queueDraw(RenderPass::Transparent, getObjectProgram(ShaderFeatureTextured), _flashtexs[_currentFlashtex].get(), *_flashModel, model, params, view);
 	}
 }
 
-void Scene::renderLightIndicator() {
-    _shader->use();
-    _shader->setUniformMat4("projection", _camera->getProjectionMatrix());
-    _shader->setUniformMat4("view", _camera->getViewMatrix());
-    _shader->setUniformVec3("lightPos", _lightPosition);
-    _shader->setUniformVec3("lightColor", _lightColor);
-    _shader->setUniformVec3("viewPos", _camera->transform.position);
-    _shader->setUniformFloat("lightIntensity", _lightIntensity);
-    _shader->setUniformFloat("ambientStrength", 1.0f); 
-    _shader->setUniformFloat("specularStrength", 0.0f);
-    _shader->setUniformFloat("shininess", 1.0f);
-
+void Scene::queueLightIndicator(const glm::mat4& view) {
     glm::mat4 model = glm::mat4(1.0f);
+    DrawParams params;
     model = glm::translate(model, _lightPosition);
     model = glm::scale(model, glm::vec3(0.3f)); // 小球形光源
-
-    _shader->setUniformMat4("model", model);
-    _shader->setUniformVec3("objectColor", _lightColor);
-
-    if (_sphereModel) {
-        _sphereModel->draw();
+    params.color = _lightColor;
+    params.ambientStrength = 1.0f;
+    params.specularStrength = 0.0f;
+    params.shininess = 1.0f;
+
+    if (!_sphereModel) { return; }
+    if (!_frustum.intersect(_sphereModel->getBoundingBox(), model)) {
+        ++_culled.models;
+        return;
     }
+    queueDraw(RenderPass::Opaque, getObjectProgram(ShaderFeatureLit), nullptr, *_sphereModel, model, params, view);
 }
 
 void Scene::resetGame() {
-	_gameState = GameState::WaitingToStart;
-	_gameTime = 0.0f;
-	_currentWave = 1;
-	_waveTimer = 0.0f;
-	_breakTimer = 0.0f;
-	_player.health = 3;
-	_player.position = glm::vec3(0.0f, 0.0f, 0.0f);
-	_bullets.clear();
-	_blinkTimer = 0.0f;
-	_showStartText = true;
+	SimulationEvent event;
+	event.type = SimulationEventType::ResetGame;
+	pushSimulationEvent(event);
 	
 	// 重置光照参数为默认值
 	_lightPosition = glm::vec3(5.0f, 10.0f, 5.0f);
@@ -1129,36 +1526,27 @@ void Scene::resetGame() {
 	_prevTabPressed = false;
 	_cameraControlMode = true;
 	glfwSetInputMode(_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	setupCameraForGameState();
-	setupLaunchers(_initialLaunchers);
+	setupCameraForGameState(GameState::WaitingToStart);
 }
 
 void Scene::startGame() {
-	_gameState = GameState::Playing;
-	_gameTime = 0.0f;
-	_waveTimer = 0.0f;
+	SimulationEvent event;
+	event.type = SimulationEventType::StartGame;
+	pushSimulationEvent(event);
 	
 	_firstMouse = true;
 	_cameraControlMode = true;
 	glfwSetInputMode(_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-	setupCameraForGameState();
-	setupLaunchers(_initialLaunchers);
-}
-
-void Scene::updateWaitingState() {
-	_blinkTimer += _deltaTime;
-	if (_blinkTimer >= 0.8f) {
-		_showStartText = !_showStartText;
-		_blinkTimer = 0.0f;
-	}
+	setupCameraForGameState(GameState::Playing);
 }
 
 void Scene::renderStartScreen() {
+	ProfileScope scope(_profiler, "imgui start screen");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 	
-	if (_showStartText) {
+	if (_snapshots.getReadBuffer().showStartText) {
 		ImGuiIO& io = ImGui::GetIO();
 		ImVec2 textSize = ImGui::CalcTextSize("Press 'Enter' to Start Game");
     _textrenderer->renderText("Press 'Enter' to Start Game", 680.0f, 540.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
@@ -1177,11 +1565,31 @@ void Scene::renderStartScreen() {
     
 		ImGui::End();
 	}
+
+	if (_showProfiler) {
+		renderProfilerWindow();
+	}
 	
 	ImGui::Render();
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+void Scene::toggleTracing() {
+	if (!Tracer::isEnabled()) {
+		Tracer::start();
+		std::cout << "tracing started, press F4 again to write " << _traceOutputPath << std::endl;
+		return;
+	}
+
+	Tracer::stop();
+	try {
+		Tracer::writeChromeJson(_traceOutputPath);
+		std::cout << "trace written to " << _traceOutputPath << std::endl;
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+	}
+}
+
 void Scene::saveScreenshot() {
 	int width = _windowWidth;
   int height = _windowHeight;
@@ -1238,13 +1646,14 @@ void Scene::handleMouseCamera() {
 	front.z = sin(glm::radians(_yaw)) * cos(glm::radians(_pitch));
 	front = glm::normalize(front);
 	
-	if (_gameState == GameState::WaitingToStart) {
+	const SceneSnapshot& snapshot = _snapshots.getReadBuffer();
+	if (snapshot.gameState == GameState::WaitingToStart) {
 		_camera->transform.position = _freeCameraPos;
 		_camera->transform.lookAt(_freeCameraPos + front, glm::vec3(0.0f, 1.0f, 0.0f));
 	}
-	else if (_gameState == GameState::Playing || _gameState == GameState::WaveBreak) {
-		_camera->transform.position = _player.position + glm::vec3(0.0f, 1.0f, 0.0f);
-		_camera->transform.lookAt(_player.position + glm::vec3(0.0f, 1.0f, 0.0f) + front, glm::vec3(0.0f, 1.0f, 0.0f));
+	else if (snapshot.gameState == GameState::Playing || snapshot.gameState == GameState::WaveBreak) {
+		_camera->transform.position = snapshot.playerPosition + glm::vec3(0.0f, 1.0f, 0.0f);
+		_camera->transform.lookAt(snapshot.playerPosition + glm::vec3(0.0f, 1.0f, 0.0f) + front, glm::vec3(0.0f, 1.0f, 0.0f));
 	}
 }
 
@@ -1280,8 +1689,9 @@ void Scene::handleFreeCameraMovement() {
 	}
 }
 
-void Scene::setupCameraForGameState() {
-	if (_gameState == GameState::WaitingToStart) {
+void Scene::setupCameraForGameState(GameState gameState) {
+	const glm::vec3& playerPosition = _snapshots.getReadBuffer().playerPosition;
+	if (gameState == GameState::WaitingToStart) {
 		_camera->transform.position = _freeCameraPos;
 		_camera->transform.lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 		if (_yaw == 0.0f && _pitch == 0.0f) {
@@ -1289,18 +1699,19 @@ void Scene::setupCameraForGameState() {
 			_pitch = 0.0f;
 		}
 	}
-	else if (_gameState == GameState::Playing || _gameState == GameState::WaveBreak) {
+	else if (gameState == GameState::Playing || gameState == GameState::WaveBreak) {
 		if (_yaw == 0.0f && _pitch == 0.0f) {
 			_yaw = -90.0f;
 			_pitch = 0.0f;
 		}
-		_camera->transform.position = _player.position + glm::vec3(0.0f, 1.0f, 0.0f);
-		_camera->transform.lookAt(_player.position + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		_camera->transform.position = playerPosition + glm::vec3(0.0f, 1.0f, 0.0f);
+		_camera->transform.lookAt(playerPosition + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 	}
 }
 
 void Scene::renderCrosshair() {
 	if (!_cameraControlMode) return;
+	ProfileScope scope(_profiler, "imgui crosshair");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -1334,88 +1745,30 @@ void Scene::renderCrosshair() {
 }
 
 glm::vec3 Scene::screenToWorldRay(float mouseX, float mouseY) {
-	glm::mat4 projection = _camera->getProjectionMatrix();
-	glm::mat4 view = _camera->getViewMatrix();
-	glm::vec4 viewport = glm::vec4(0, 0, _windowWidth, _windowHeight);
-	
-	glm::vec3 nearPoint = glm::unProject(
-		glm::vec3(mouseX, _windowHeight - mouseY, 0.0f),
-		view, projection, viewport
-	);
-	
-	glm::vec3 farPoint = glm::unProject(
-		glm::vec3(mouseX, _windowHeight - mouseY, 1.0f),
-		view, projection, viewport
-	);
-	
-	return glm::normalize(farPoint - nearPoint);
-}
+	// 用相机缓存的逆视图投影矩阵，不再每次调用 unProject 求两次逆
+	const glm::mat4& inverseViewProjection = _camera->getInverseViewProjectionMatrix();
+	const float x = 2.0f * mouseX / _windowWidth - 1.0f;
+	const float y = 1.0f - 2.0f * mouseY / _windowHeight;
 
-bool Scene::rayIntersectsSphere(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, 
-                               const glm::vec3& sphereCenter, float sphereRadius, float& distance) {
-	glm::vec3 oc = rayOrigin - sphereCenter;
-	float a = glm::dot(rayDirection, rayDirection);
-	float b = 2.0f * glm::dot(oc, rayDirection);
-	float c = glm::dot(oc, oc) - sphereRadius * sphereRadius;
-	
-	float discriminant = b * b - 4 * a * c;
-	if (discriminant < 0) {
-		return false;
-	}
-	
-	float t1 = (-b - sqrt(discriminant)) / (2.0f * a);
-	float t2 = (-b + sqrt(discriminant)) / (2.0f * a);
-	
-	if (t1 > 0) {
-		distance = t1;
-		return true;
-	} else if (t2 > 0) {
-		distance = t2;
-		return true;
-	}
-	
-	return false;
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+	nearPoint /= nearPoint.w;
+	farPoint /= farPoint.w;
+
+	return glm::normalize(glm::vec3(farPoint - nearPoint));
 }
 
 void Scene::handleMouseClick() {
-	glm::vec3 rayOrigin = _camera->transform.position;
-	
-	glm::vec3 rayDirection = screenToWorldRay(_windowWidth * 0.5f, _windowHeight * 0.5f);
-	
-	float closestDistance = std::numeric_limits<float>::max();
-	int closestBulletIndex = -1;
-	
-	for (size_t i = 0; i < _bullets.size(); ++i) {
-		const auto& bullet = _bullets[i];
-		if (!bullet.active || bullet.destroying) continue;
-		
-		float effectiveRadius = bullet.radius * 2.0f;
-		
-		float distance;
-		if (rayIntersectsSphere(rayOrigin, rayDirection, bullet.position, effectiveRadius, distance)) {
-			
-			if (distance < closestDistance) {
-				closestDistance = distance;
-				closestBulletIndex = static_cast<int>(i);
-			}
-		}
-	}
-	
-	if (closestBulletIndex >= 0) {
-		startBulletDestroy(closestBulletIndex);
-	}
+	SimulationEvent event;
+	event.type = SimulationEventType::Fire;
+	event.rayOrigin = _camera->transform.position;
+	event.rayDirection = screenToWorldRay(_windowWidth * 0.5f, _windowHeight * 0.5f);
+	pushSimulationEvent(event);
 
 	_isRecoiling = true;
 	_isFlashing = true;
 }
 
-void Scene::startBulletDestroy(size_t bulletIndex) {
-	if (bulletIndex < _bullets.size()) {
-		_bullets[bulletIndex].destroying = true;
-		_bullets[bulletIndex].destroyTimer = 0.0f;
-	}
-}
-
 void Scene::toggleMouseMode() {
 	_cameraControlMode = !_cameraControlMode;
 	
@@ -1,52 +1,36 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <chrono>
 #include "text.h"
 
+#include "../base/allocation_tracker.h"
 #include "../base/application.h"
 #include "../base/camera.h"
+#include "../base/frustum_culling.h"
+#include "../base/gl_call_stats.h"
+#include "../base/gl_state_cache.h"
+#include "../base/gl_resource_registry.h"
 #include "../base/glsl_program.h"
+#include "../base/hitch_detector.h"
 #include "../base/model.h"
+#include "../base/normal_matrix.h"
+#include "../base/profiler.h"
+#include "../base/render_queue.h"
+#include "../base/shader_library.h"
+#include "../base/tracer.h"
 #include "../base/skybox.h"
+#include "../base/spsc_queue.h"
+#include "../base/stream_buffer.h"
 #include "../base/texture2d.h"
+#include "../base/triple_buffer.h"
+#include "../base/uniform_buffer.h"
+#include "benchmark.h"
+#include "game_world.h"
 
 
-enum class GameState {
-    WaitingToStart,
-    Playing,
-    WaveBreak,
-    GameOver
-};
-
-struct Player {
-    glm::vec3 position{0.0f, 0.0f, 0.0f};
-    float moveRange = 5.0f;
-    int health = 3;
-    float radius = 0.5f;
-    std::unique_ptr<Model> model;
-};
-
-struct Bullet {
-    glm::vec3 position;
-    glm::vec3 velocity;
-    glm::vec3 color{1.0f, 1.0f, 1.0f};
-    float radius = 0.2f;
-    bool active = true;
-    bool destroying = false;
-    float destroyTimer = 0.0f;
-    float destroyDuration = 0.5f;
-    std::unique_ptr<Model> model;
-};
-
-struct Launcher {
-    glm::vec3 position;
-    float fireInterval = 1.0f;
-    float lastFireTime = 0.0f;
-    glm::vec3 targetPosition;
-};
-
 struct Gun {
     glm::vec3 position{0.5f, -0.35f, -0.75f};
     glm::vec3 direction{0.0f, 0.0f, -1.0f};
@@ -56,30 +40,56 @@ struct MuzzleFlash {
     glm::vec3 position{0.5f, -0.1f, -1.2f};
 };
 
+struct InputRecording;
+
 class Scene : public Application {
 public:
     Scene(const Options& options);
     ~Scene();
 
     void handleInput() override;
+    void updateSimulation() override;
     void renderFrame() override;
 
+    // records every simulation event from now on, written out by finishRecording()
+    void startRecording(const std::string& path);
+    void finishRecording();
+
+    // re-runs a recording at fixed dt as fast as possible and checks the final state hash;
+    // writes per-tick timings as csv when tracePath is not empty
+    void replay(const std::string& path, bool render, const std::string& tracePath);
+
+    // ramps the bullet count up over fixed stages with a scripted camera and writes frame
+    // time percentiles per stage to reportPath as json
+    void benchmark(const std::string& reportPath, int framesPerStage);
+
+    // cpu time per bullet draw for each way of setting its uniforms
+    UniformOverheadResult measureUniformOverhead(int draws);
+
+    // frames over budgetFactor times the median frame time (and at least minBudgetMs) are dumped
+    void setHitchBudget(float budgetFactor, float minBudgetMs) {
+        _hitchDetector.setBudget(budgetFactor, minBudgetMs);
+    }
+
+    // test mode: a gameplay frame (after a short warm-up) that allocates more than this on the
+    // render thread prints its scopes and closes the window; needs TRACK_ALLOCATIONS
+    void setAllocationBudget(int allocationsPerFrame);
+
+    bool hasExceededAllocationBudget() const {
+        return _allocationBudgetExceeded;
+    }
+
+    // where F4 writes its trace
+    void setTraceOutputPath(const std::string& path) {
+        _traceOutputPath = path;
+    }
+
 private:
-    // Game state
-    GameState _gameState = GameState::WaitingToStart;
-    float _gameTime = 0.0f;
-    int _currentWave = 1;
-    float _waveTime = 30.0f;
-    float _waveTimer = 0.0f;
-    float _breakTime = 5.0f;
-    float _breakTimer = 0.0f;
+    // Game rules, only touched by the simulation (see updateSimulation)
+    GameWorld _world;
 
     int _currentFlashtex = 0;
     
-    // UI effects
-    float _blinkTimer = 0.0f;
-    bool _showStartText = true;
-    
     // Camera
     std::unique_ptr<PerspectiveCamera> _camera;
     float _cameraDistance = 15.0f;
@@ -105,24 +115,100 @@ private:
     // Mouse mode for UI/Camera control
     bool _cameraControlMode = true;
     bool _prevTabPressed = false;
+
+    // Render pass timings, F3 shows them over the game
+    Profiler _profiler;
+    bool _showProfiler = false;
+    bool _prevF3Pressed = false;
+    HitchDetector _hitchDetector;
+
+    // test mode, see setAllocationBudget()
+    int _allocationBudget = -1;
+    int _steadyFrames = 0;
+    bool _allocationBudgetExceeded = false;
+
+    // F4 starts and stops a chrome trace
+    std::string _traceOutputPath = "trace.json";
+    bool _prevF4Pressed = false;
     
-    // Game objects
-    Player _player;
-    std::vector<Bullet> _bullets;
-    std::vector<Launcher> _launchers;
+    std::unique_ptr<InputRecording> _recording;
+    std::string _recordingPath;
+
+    // Simulation <-> render thread hand-off
+    SpscQueue<SimulationEvent, 256> _simulationEvents;
+    TripleBuffer<SceneSnapshot> _snapshots;
+    GameParams _inspectorParams;
+    float _sentMoveAxis = 0.0f;
+    float _renderAlpha = 0.0f;
+
     Gun _gun;
     MuzzleFlash _muzzleFlash;
     
     // Rendering
-    std::unique_ptr<GLSLProgram> _shader;
-    std::unique_ptr<GLSLProgram> _texshader;
-    std::unique_ptr<GLSLProgram> _litTexShader;  // 带光照的纹理着色器
+    // object.vert/object.frag variants, compiled the first time a feature set is drawn
+    std::unique_ptr<ShaderLibrary> _shaderLibrary;
+    // set once per draw, resolved right after linking; a variant without one of them leaves
+    // its handle invalid, which setUniform() ignores
+    struct ObjectUniforms {
+        UniformHandle<glm::mat4> model;
+        UniformHandle<glm::mat3> normalMatrix;
+        UniformHandle<glm::vec3> objectColor;
+        UniformHandle<float> ambientStrength;
+        UniformHandle<float> specularStrength;
+        UniformHandle<float> shininess;
+        UniformHandle<float> morphWeight;
+    };
+    struct ObjectProgram {
+        GLSLProgram* program = nullptr;
+        ObjectUniforms uniforms;
+    };
+    // by ShaderFeature bits, see getObjectProgram()
+    std::unordered_map<uint32_t, ObjectProgram> _objectPrograms;
+    // FrameConstants block shared by every variant, see initFrameConstants()
+    std::unique_ptr<UniformBuffer> _frameConstants;
+    // camera version the constants hold, see Camera::getVersion()
+    uint32_t _frameConstantsCameraVersion = 0;
     std::unique_ptr<Model> _sphereModel;
     std::unique_ptr<Model> _cylinderModel;
     std::unique_ptr<Model> _turretModel[2];
+    // the second keyframe is set as the first one's morph target, see initGameObjects()
+    bool _turretMorphReady = false;
     std::unique_ptr<Model> _gunModel;
     std::unique_ptr<Model> _flashModel;
     std::unique_ptr<SkyBox> _skybox;
+
+    // the frame's draws, rebuilt by buildRenderQueue() and submitted through _glState
+    struct DrawParams {
+        glm::vec3 color;
+        float ambientStrength;
+        float specularStrength;
+        float shininess;
+        float morphWeight = 0.0f;
+        // the uniforms of the variant the item is drawn with, set by queueDraw()
+        const ObjectUniforms* uniforms = nullptr;
+    };
+    RenderQueue _renderQueue;
+    // indexed by DrawItem::userIndex, the matrices apart so they can be batched
+    std::vector<glm::mat4> _drawModels;
+    std::vector<glm::mat3> _drawNormalMatrices;
+    std::vector<DrawParams> _drawParams;
+    std::vector<glm::mat4> _launcherTransforms;
+    std::vector<float> _launcherTimes;
+
+    // frustum culling while the queue is built, counts of the current frame
+    struct CullingCounts {
+        uint32_t bullets = 0;
+        uint32_t launchers = 0;
+        uint32_t models = 0;
+    };
+    Frustum _frustum;
+    BoundingSpheres _bulletBounds;
+    BoundingBoxes _launcherBounds;
+    std::vector<uint8_t> _visible;
+    CullingCounts _culled;
+    GLStateCache _glState;
+    // per frame vertex data (text quads), fenced once at the end of renderFrame()
+    std::unique_ptr<StreamBuffer> _streamBuffer;
     
     // Texture
     std::shared_ptr<Texture2D> _turrettex;
@@ -132,14 +218,6 @@ private:
     // Text
     std::unique_ptr<TextRenderer> _textrenderer;
 
-    // Game parameters
-    float _bulletSpeed = 2.0f;
-    int _initialLaunchers = 2;
-    int _launchersPerWave = 2;
-    float _launcherRadius = 8.0f;
-    float _fireInterval = 1.0f;
-    float _waveBreakTime = 5.0f;
-    
     // Lighting parameters
     glm::vec3 _lightPosition = glm::vec3(5.0f, 10.0f, 5.0f);
     glm::vec3 _lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -149,39 +227,40 @@ private:
     float _shininess = 32.0f;
     
     // Methods
-    void initShader();
-    void initTexShader();
-    void initLitTexShader();  // 初始化带光照的纹理着色器，用于模型的光照
+    void initFrameConstants();
+    const ObjectProgram& getObjectProgram(uint32_t features);
     void initGameObjects();
     void initTex();
-    void updateGame();
-    void updatePlayer();
-    void updateBullets();
-    void updateLaunchers();
+    JobSystem::JobHandle loadModelAsync(std::unique_ptr<Model>& model, const std::string& relPath);
+    JobSystem::JobHandle loadTextureAsync(std::shared_ptr<Texture2D>& texture, const std::string& relPath);
     void updateGun();
     void updateCamera();
-    void checkCollisions();
-    void handleWaveTransition();
-    void spawnBullet(const Launcher& launcher);
+    void pushSimulationEvent(const SimulationEvent& event);
+    void publishSnapshot();
+    glm::vec3 interpolate(const glm::vec3& previous, const glm::vec3& current) const;
     void destroyBullet(size_t index);
-    void renderPlayer();
-    void renderBullets();
-    void renderLaunchers();
-    void renderGun();
-    void renderMuzzleFlash();
-    void renderLightIndicator();
+    void buildRenderQueue(GameState gameState, const glm::mat4& view);
+    void queueDraw(RenderPass pass, const ObjectProgram& program, const Texture2D* texture,
+                   const Model& mesh, const glm::mat4& model, const DrawParams& params,
+                   const glm::mat4& view);
+    void applyDrawParams(const GLSLProgram& program, uint32_t index) const;
+    void queuePlayer(const glm::mat4& view);
+    void queueBullets(const glm::mat4& view);
+    void queueLaunchers(const glm::mat4& view);
+    void queueGun(const glm::mat4& view);
+    void queueMuzzleFlash(const glm::mat4& view);
+    void queueLightIndicator(const glm::mat4& view);
+    void renderSkybox(const glm::mat4& projection, const glm::mat4& view);
     void renderUI();
     void renderGameUI();
     void renderCrosshair();
     void renderWaveBreakUI();
-    void setupLaunchers(int count);
     void resetGame();
     void startGame();
-    void updateWaitingState();
     void renderStartScreen();
-    bool isPlayerHit(const Bullet& bullet) const;
-    void takeDamage();
     void saveScreenshot();
+    void toggleTracing();
+    void checkAllocationBudget();
     
     // Camera controls
     void handleCameraInput();
@@ -189,14 +268,11 @@ private:
     void zoomCamera(float deltaZoom);
     void handleMouseCamera();
     void handleFreeCameraMovement();
-    void setupCameraForGameState();
+    void setupCameraForGameState(GameState gameState);
     
     // Ray casting for mouse clicks
     glm::vec3 screenToWorldRay(float mouseX, float mouseY);
-    bool rayIntersectsSphere(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, 
-                           const glm::vec3& sphereCenter, float sphereRadius, float& distance);
     void handleMouseClick();
-    void startBulletDestroy(size_t bulletIndex);
     void toggleMouseMode();
 
     /// <summary>
@@ -205,4 +281,6 @@ private:
     void initImGui();
     void clearImGui();
     void renderInspectorPanel();
+    void renderProfilerPanel();
+    void renderProfilerWindow();
 };
\ No newline at end of file
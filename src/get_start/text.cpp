@@ -1,8 +1,10 @@
 #include "text.h"
+#include "../base/gl_resource_registry.h"
+#include <cstring>
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 
-TextRenderer::TextRenderer() {
+TextRenderer::TextRenderer(StreamBuffer& streamBuffer) : streamBuffer(streamBuffer) {
     initshader();
     // 初始化 FreeType
     if (FT_Init_FreeType(&ft)) {
@@ -41,6 +43,8 @@ TextRenderer::TextRenderer() {
             GL_UNSIGNED_BYTE,
             face->glyph->bitmap.buffer
         );
+        GLResourceRegistry::onCreate(GLResourceType::Texture, texture);
+        GLResourceRegistry::setTextureSize(texture, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows);
 
         // 设置纹理选项
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -60,19 +64,28 @@ TextRenderer::TextRenderer() {
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
 
-    // 创建 VAO/VBO
+    // 创建 VAO，顶点来自共用的流式缓冲，每次绘制用起始顶点定位到本次分配的位置
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
 
     glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.getHandle());
+    GLResourceRegistry::onCreate(GLResourceType::VertexArray, VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+TextRenderer::~TextRenderer() {
+    for (auto& item : Characters) {
+        GLResourceRegistry::onDelete(GLResourceType::Texture, item.second.TextureID);
+        glDeleteTextures(1, &item.second.TextureID);
+    }
+
+    if (VAO != 0) {
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, VAO);
+        glDeleteVertexArrays(1, &VAO);
+    }
 }
 void TextRenderer::initshader(){
   const char* vscode =
@@ -108,31 +121,30 @@ void TextRenderer::renderText(const std::string& text, float x, float y, float s
     // 设置投影矩阵（例如正交）
     projection = glm::ortho(0.0f, (float)screenWidth, 0.0f, (float)screenHeight);
     shader->setUniformMat4("projection", projection);
+    layoutText(Characters, text, x, y, scale, glyphQuads);
+    if (glyphQuads.empty()) {
+        return;
+    }
+
+    // 整段文字的顶点一次写进流式缓冲，不再逐字符 glBufferSubData
+    const size_t vertexSize = sizeof(GlyphQuad::vertices[0]);
+    const StreamRange range = streamBuffer.map(sizeof(GlyphQuad::vertices) * glyphQuads.size(), vertexSize);
+    if (range.data == nullptr) {
+        return;
+    }
+    char* vertices = static_cast<char*>(range.data);
+    for (size_t i = 0; i < glyphQuads.size(); ++i) {
+        std::memcpy(vertices + i * sizeof(GlyphQuad::vertices), glyphQuads[i].vertices, sizeof(GlyphQuad::vertices));
+    }
+    streamBuffer.unmap();
+
     glActiveTexture(GL_TEXTURE0);
     glBindVertexArray(VAO);
-    for (const char& c : text) {
-        auto it = Characters.find(c);
-        if (it == Characters.end()) continue;
-        Character ch = it->second;
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // 更新 VBO 内容
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        x += (ch.Advance >> 6) * scale; // 位移，Advance 是以 1/64 像素为单位
+    GLint first = static_cast<GLint>(range.offset / vertexSize);
+    for (const GlyphQuad& quad : glyphQuads) {
+        glBindTexture(GL_TEXTURE_2D, quad.texture);
+        glDrawArrays(GL_TRIANGLES, first, 6);
+        first += 6;
     }
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
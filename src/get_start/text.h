@@ -2,29 +2,30 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <memory>
 #include "../base/glsl_program.h"
+#include "../base/stream_buffer.h"
+#include "text_layout.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 
-struct Character {
-    GLuint TextureID;
-    glm::ivec2 Size;
-    glm::ivec2 Bearing;
-    GLuint Advance;
-};
-
 class TextRenderer {
 public:
-    TextRenderer();
+    // glyph quads are streamed through streamBuffer, which must outlive the renderer
+    explicit TextRenderer(StreamBuffer& streamBuffer);
+    ~TextRenderer();
     void initshader();
+    // expects alpha blending, e.g. inside the UI render pass
     void renderText(const std::string& text, float x, float y, float scale, glm::vec3 color);
 
 private:
     std::map<char, Character> Characters;
-    GLuint VAO, VBO;
+    std::vector<GlyphQuad> glyphQuads;
+    StreamBuffer& streamBuffer;
+    GLuint VAO = 0;
     std::unique_ptr<GLSLProgram> shader;
     glm::mat4 projection;
     FT_Library ft;    
@@ -0,0 +1,24 @@
+#include "text_layout.h"
+
+void layoutText(const std::map<char, Character>& characters, const std::string& text, float x,
+                float y, float scale, std::vector<GlyphQuad>& quads) {
+    quads.clear();
+    for (const char& c : text) {
+        auto it = characters.find(c);
+        if (it == characters.end()) continue;
+        const Character& ch = it->second;
+        float xpos = x + ch.Bearing.x * scale;
+        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+        float w = ch.Size.x * scale;
+        float h = ch.Size.y * scale;
+        quads.push_back({ch.TextureID,
+                         {{xpos, ypos + h, 0.0f, 0.0f},
+                          {xpos, ypos, 0.0f, 1.0f},
+                          {xpos + w, ypos, 1.0f, 1.0f},
+
+                          {xpos, ypos + h, 0.0f, 0.0f},
+                          {xpos + w, ypos, 1.0f, 1.0f},
+                          {xpos + w, ypos + h, 1.0f, 0.0f}}});
+        x += (ch.Advance >> 6) * scale; // 位移，Advance 是以 1/64 像素为单位
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../base/gl_utility.h"
+
+struct Character {
+    GLuint TextureID;
+    glm::ivec2 Size;
+    glm::ivec2 Bearing;
+    GLuint Advance;
+};
+
+// one textured quad per glyph, two triangles of (x, y, u, v)
+struct GlyphQuad {
+    GLuint texture;
+    float vertices[6][4];
+};
+
+// positions the glyphs of text starting at the baseline (x, y); characters missing from
+// the font are skipped. No GL calls, the quads are drawn by TextRenderer.
+void layoutText(const std::map<char, Character>& characters, const std::string& text, float x,
+                float y, float scale, std::vector<GlyphQuad>& quads);
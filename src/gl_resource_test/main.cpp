@@ -0,0 +1,118 @@
+#include <iostream>
+
+#include "../base/gl_resource_registry.h"
+
+namespace {
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+}  // namespace
+
+// The registry's bookkeeping as the wrappers drive it, without a GL context: the handles are
+// made up and only the GL enums of the formats are used.
+int main() {
+    GLResourceRegistry::beginFrame();
+
+    {
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, 1);
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, 2);
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, 3);
+        // names are only unique within one type
+        GLResourceRegistry::onCreate(GLResourceType::Texture, 1);
+        GLResourceRegistry::onCreate(GLResourceType::Query, 1);
+        // reported twice, and the zero name GL never hands out
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, 3);
+        GLResourceRegistry::onCreate(GLResourceType::Buffer, 0);
+
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).live == 3, "live buffers");
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).live == 1, "live textures");
+        check(GLResourceRegistry::getStats(GLResourceType::Query).live == 1, "live queries");
+        check(GLResourceRegistry::getTotalStats().live == 5, "live objects of all types");
+
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, 2);
+        // never created
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, 42);
+        GLResourceRegistry::onDelete(GLResourceType::VertexArray, 1);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).live == 2,
+              "live buffers after a delete");
+        check(GLResourceRegistry::getStats(GLResourceType::VertexArray).live == 0,
+              "deleting an unknown object changes nothing");
+    }
+
+    {
+        // glBufferData replaces the storage, the new size does not add to the old one
+        GLResourceRegistry::setBufferSize(1, 1000);
+        GLResourceRegistry::setBufferSize(3, 24);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).bytes == 1024, "buffer bytes");
+        GLResourceRegistry::setBufferSize(1, 400);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).bytes == 424,
+              "setBufferSize() replaces the previous size");
+        // the buffer was deleted, nothing is recorded for it
+        GLResourceRegistry::setBufferSize(2, 4096);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).bytes == 424,
+              "setBufferSize() ignores unknown buffers");
+        GLResourceRegistry::onDelete(GLResourceType::Buffer, 3);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).bytes == 400,
+              "a deleted buffer takes its bytes along");
+    }
+
+    {
+        // a cube map: six 256x128 RGBA8 faces
+        const uint64_t level0 = 256 * 128 * 6 * 4;
+        GLResourceRegistry::setTextureSize(1, GL_RGBA8, 256, 128, 6);
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).bytes == level0,
+              "texture bytes of level 0 of every layer");
+
+        // 256x128, 128x64, 64x32, 32x16, 16x8, 8x4, 4x2, 2x1 and 1x1 texels per layer
+        const uint64_t chain = (32768 + 8192 + 2048 + 512 + 128 + 32 + 8 + 2 + 1) * 6 * 4;
+        GLResourceRegistry::setTextureMipmapped(1);
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).bytes == chain,
+              "mipmapped texture bytes down to 1x1");
+        GLResourceRegistry::setTextureMipmapped(1);
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).bytes == chain,
+              "mipmapping twice counts the chain once");
+
+        // new level 0 storage drops the generated levels
+        GLResourceRegistry::setTextureSize(1, GL_RGB16F, 64, 64);
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).bytes == 64 * 64 * 6,
+              "texture bytes after new storage");
+
+        GLResourceRegistry::onDelete(GLResourceType::Texture, 1);
+        check(GLResourceRegistry::getStats(GLResourceType::Texture).bytes == 0,
+              "a deleted texture takes its bytes along");
+    }
+
+    {
+        // the counts of the frame so far only show up once it is closed
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).created == 0,
+              "creations of the open frame are not reported yet");
+        GLResourceRegistry::beginFrame();
+        const GLResourceStats buffers = GLResourceRegistry::getStats(GLResourceType::Buffer);
+        check(buffers.created == 3 && buffers.deleted == 2, "buffer churn of the last frame");
+        const GLResourceStats total = GLResourceRegistry::getTotalStats();
+        check(total.created == 5 && total.deleted == 3, "churn of all types in the last frame");
+
+        GLResourceRegistry::onCreate(GLResourceType::Sampler, 7);
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).created == 3,
+              "the last frame's counts stay until the next beginFrame()");
+        GLResourceRegistry::beginFrame();
+        check(GLResourceRegistry::getStats(GLResourceType::Buffer).created == 0 &&
+                  GLResourceRegistry::getStats(GLResourceType::Buffer).deleted == 0,
+              "a frame without buffer churn reports none");
+        check(GLResourceRegistry::getStats(GLResourceType::Sampler).created == 1,
+              "a creation counts in the frame it happened in");
+        GLResourceRegistry::beginFrame();
+        check(GLResourceRegistry::getTotalStats().created == 0, "counts roll over every frame");
+        check(GLResourceRegistry::getTotalStats().live == 3, "live counts do not roll over");
+    }
+
+    if (failures == 0) {
+        std::cout << "all gl resource registry checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
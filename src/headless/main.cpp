@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "../base/job_system.h"
+#include "../get_start/game_world.h"
+
+namespace {
+struct LoadOptions {
+    int launchers = 64;
+    int bullets = 10000;
+    int ticks = 6000;
+    float rate = 60.0f;
+    int threads = -1;
+};
+
+void printUsage() {
+    std::cout << "usage: headless [--launchers N] [--bullets N] [--ticks N] [--rate hz] "
+                 "[--threads N]"
+              << std::endl;
+}
+} // namespace
+
+// Runs the game rules without a window to measure how the simulation scales with the
+// number of launchers and live bullets.
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--launchers") == 0 && hasValue) {
+            options.launchers = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--bullets") == 0 && hasValue) {
+            options.bullets = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            options.ticks = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--rate") == 0 && hasValue) {
+            options.rate = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // --threads 0 runs every bullet update on the calling thread
+    JobSystem jobSystem(options.threads < 0 ? -1 : std::max(1, options.threads));
+    GameWorld world(options.threads == 0 ? nullptr : &jobSystem);
+
+    // a bullet lives from the launcher ring until it is 20 units past the center, so
+    // this interval keeps about the requested number of bullets alive
+    GameParams params;
+    params.initialLaunchers = options.launchers;
+    const float lifetime = (params.launcherRadius + 20.0f) / params.bulletSpeed;
+    params.fireInterval = options.launchers * lifetime / options.bullets;
+    params.waveTime = 1.0e9f;
+
+    world.restart(params);
+    world.setInvulnerable(true);
+
+    SimulationEvent start;
+    start.type = SimulationEventType::StartGame;
+    world.applyEvent(start);
+
+    const float deltaTime = 1.0f / options.rate;
+    const int warmupTicks = static_cast<int>(lifetime / deltaTime) + 1;
+    for (int i = 0; i < warmupTicks; ++i) {
+        world.tick(deltaTime);
+    }
+
+    double bulletSum = 0.0;
+    const auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < options.ticks; ++i) {
+        world.tick(deltaTime);
+        bulletSum += world.getBulletCount();
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    std::printf("launchers %zu, threads %d, %d ticks at %.0f Hz\n", world.getLauncherCount(),
+                options.threads == 0 ? 0 : jobSystem.getWorkerCount(), options.ticks,
+                options.rate);
+    std::printf("average bullets %.0f\n", bulletSum / options.ticks);
+    std::printf("%.0f ticks/s, %.2f us per tick\n", options.ticks / seconds,
+                seconds * 1.0e6 / options.ticks);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/ext.hpp>
+
+#include "../base/normal_matrix.h"
+
+namespace {
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// largest element difference, relative to the largest element of the expected matrix
+float relativeError(const glm::mat3& actual, const glm::mat3& expected) {
+    float difference = 0.0f;
+    float magnitude = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            difference = std::max(difference, std::abs(actual[column][row] - expected[column][row]));
+            magnitude = std::max(magnitude, std::abs(expected[column][row]));
+        }
+    }
+    return difference / std::max(magnitude, 1e-6f);
+}
+
+glm::mat3 referenceNormalMatrix(const glm::mat4& model) {
+    return glm::transpose(glm::inverse(glm::mat3(model)));
+}
+
+glm::mat4 makeTRS(
+    const glm::vec3& translation, float angle, const glm::vec3& axis, const glm::vec3& scale) {
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), translation);
+    model = glm::rotate(model, angle, glm::normalize(axis));
+    return glm::scale(model, scale);
+}
+
+// computeNormalMatrix() and computeNormalMatrices() against the reference, returns the larger error
+float checkMatrices(const std::vector<glm::mat4>& models, float tolerance, const char* what) {
+    std::vector<glm::mat3> batch(models.size());
+    computeNormalMatrices(models.data(), batch.data(), models.size());
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < models.size(); ++i) {
+        const glm::mat3 expected = referenceNormalMatrix(models[i]);
+        maxError = std::max(maxError, relativeError(computeNormalMatrix(models[i]), expected));
+        maxError = std::max(maxError, relativeError(batch[i], expected));
+    }
+    check(maxError <= tolerance, what);
+    return maxError;
+}
+}  // namespace
+
+// Normal matrices against glm's transpose(inverse(mat3(m))) for the general inverse, mirrors and
+// the uniform scale fast path. Deterministic and without GL.
+int main() {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> translation(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+    std::uniform_real_distribution<float> axis(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 10.0f);
+    std::uniform_int_distribution<int> mirroredAxis(0, 2);
+
+    auto randomAxis = [&]() {
+        glm::vec3 value(axis(random), axis(random), axis(random));
+        return glm::length(value) < 0.1f ? glm::vec3(0.0f, 1.0f, 0.0f) : value;
+    };
+    auto randomTranslation = [&]() {
+        return glm::vec3(translation(random), translation(random), translation(random));
+    };
+
+    const float tolerance = 1e-5f;
+    const int count = 10000;
+
+    std::vector<glm::mat4> general;
+    std::vector<glm::mat4> mirrored;
+    std::vector<glm::mat4> uniform;
+    std::vector<glm::mat4> mirroredUniform;
+    for (int i = 0; i < count; ++i) {
+        const glm::vec3 t = randomTranslation();
+        const float a = angle(random);
+        const glm::vec3 r = randomAxis();
+        glm::vec3 s(scale(random), scale(random), scale(random));
+        general.push_back(makeTRS(t, a, r, s));
+
+        s[mirroredAxis(random)] *= -1.0f;
+        mirrored.push_back(makeTRS(t, a, r, s));
+
+        const float u = scale(random);
+        uniform.push_back(makeTRS(t, a, r, glm::vec3(u)));
+
+        glm::vec3 mirror(u);
+        mirror[mirroredAxis(random)] = -u;
+        mirroredUniform.push_back(makeTRS(t, a, r, mirror));
+    }
+
+    const float generalError = checkMatrices(general, tolerance, "random TRS matrices");
+    const float mirroredError = checkMatrices(mirrored, tolerance, "mirrored TRS matrices");
+    const float uniformError = checkMatrices(uniform, tolerance, "uniform scale fast path");
+    const float mirroredUniformError =
+        checkMatrices(mirroredUniform, tolerance, "mirrored uniform scale fast path");
+
+    {
+        // the fast path divides the upper 3x3 by s^2 instead of inverting it
+        const glm::mat4 model = makeTRS(
+            glm::vec3(1.0f, 2.0f, 3.0f), 0.7f, glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3(2.0f));
+        const glm::mat3 expected = glm::mat3(model) / 4.0f;
+        check(relativeError(computeNormalMatrix(model), expected) <= tolerance,
+              "uniform scale divides by s^2");
+        check(computeNormalMatrix(glm::mat4(1.0f)) == glm::mat3(1.0f),
+              "identity stays the identity");
+    }
+
+    std::cout << "max relative error: general " << generalError << ", mirrored " << mirroredError
+              << ", uniform " << uniformError << ", mirrored uniform " << mirroredUniformError
+              << std::endl;
+    if (failures == 0) {
+        std::cout << "all normal matrix checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}